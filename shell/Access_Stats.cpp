@@ -0,0 +1,137 @@
+#include "Access_Stats.h"
+#include "Directory.h"
+#include <algorithm>
+using namespace std;
+
+atomic<uint32_t> Access_Stats::sketch[Access_Stats::DEPTH][Access_Stats::WIDTH];
+atomic<uint32_t> Access_Stats::events(0);
+vector<Access_Stats::Hot_Entry> Access_Stats::candidates;
+thread_local int Access_Stats::bulkDepth = 0;
+
+void Access_Stats::record(const Directory* parent, const Directory_Entry& entry)
+{
+    int cluster = entry.dir_firstCluster;
+    if (cluster <= 0 || bulkDepth > 0)
+        return;
+    for (int row = 0; row < DEPTH; row++)
+        sketch[row][slot(row, cluster)].fetch_add(1, memory_order_relaxed);
+    if ((events.fetch_add(1, memory_order_relaxed) + 1) % DECAY_INTERVAL == 0)
+        decay();
+
+    uint32_t count = estimate(cluster);
+    string name = entry.getName();
+    for (auto& candidate : candidates)
+    {
+        if (candidate.cluster == cluster)
+        {
+            candidate.count = count;
+            // The entry was renamed, or its chain was freed and now starts another one
+            if (!endsWithName(candidate.path, name) || candidate.directory != (entry.dir_attr == 0x10))
+            {
+                candidate.path = pathOf(parent, name);
+                candidate.directory = entry.dir_attr == 0x10;
+            }
+            return;
+        }
+    }
+
+    // A new candidate replaces the least accessed one only once it has been used more
+    auto least = min_element(candidates.begin(), candidates.end(), [](const Hot_Entry& a, const Hot_Entry& b) {
+        return a.count < b.count;
+        });
+    if (candidates.size() >= CANDIDATES && least->count >= count)
+        return;
+
+    Hot_Entry hot;
+    hot.cluster = cluster;
+    hot.directory = entry.dir_attr == 0x10;
+    hot.count = count;
+    hot.path = pathOf(parent, name);
+    if (candidates.size() >= CANDIDATES)
+        *least = hot;
+    else
+        candidates.push_back(hot);
+}
+
+uint32_t Access_Stats::estimate(int cluster)
+{
+    uint32_t count = UINT32_MAX;
+    for (int row = 0; row < DEPTH; row++)
+        count = min(count, sketch[row][slot(row, cluster)].load(memory_order_relaxed));
+    return count;
+}
+
+bool Access_Stats::isHot(int cluster)
+{
+    return cluster > 0 && estimate(cluster) >= HOT_THRESHOLD;
+}
+
+vector<Access_Stats::Hot_Entry> Access_Stats::top(size_t n)
+{
+    vector<Hot_Entry> result;
+    for (const auto& candidate : candidates)
+    {
+        // A chain freed since it was recorded may have been reused by something else; the sketch
+        // still bounds what is left
+        Hot_Entry hot = candidate;
+        hot.count = min(hot.count, estimate(hot.cluster));
+        if (hot.count > 0)
+            result.push_back(hot);
+    }
+    sort(result.begin(), result.end(), [](const Hot_Entry& a, const Hot_Entry& b) {
+        return a.count > b.count;
+        });
+    if (result.size() > n)
+        result.resize(n);
+    return result;
+}
+
+Access_Stats::Bulk_Scope::Bulk_Scope()
+{
+    bulkDepth++;
+}
+
+Access_Stats::Bulk_Scope::~Bulk_Scope()
+{
+    bulkDepth--;
+}
+
+string Access_Stats::pathOf(const Directory* parent, const string& name)
+{
+    string path;
+    if (parent != nullptr)
+    {
+        path = parent->getFullPath();
+        if (!path.empty() && path.back() != '\\')
+            path += "\\";
+    }
+    return path + name;
+}
+
+bool Access_Stats::endsWithName(const string& path, const string& name)
+{
+    return path.size() >= name.size() && path.compare(path.size() - name.size(), name.size(), name) == 0
+        && (path.size() == name.size() || path[path.size() - name.size() - 1] == '\\');
+}
+
+// One multiplicative hash per row, each with its own odd multiplier
+size_t Access_Stats::slot(int row, int cluster)
+{
+    static const uint32_t multipliers[DEPTH] = { 0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du, 0x27D4EB2Fu };
+    uint32_t h = static_cast<uint32_t>(cluster) * multipliers[row];
+    h ^= h >> 16;
+    return h & (WIDTH - 1);
+}
+
+// Halves every count. Increments racing with this may survive or be halved; either keeps the
+// estimate approximate, which is all the sketch promises
+void Access_Stats::decay()
+{
+    for (auto& row : sketch)
+    {
+        for (auto& counter : row)
+            counter.store(counter.load(memory_order_relaxed) / 2, memory_order_relaxed);
+    }
+    for (auto& candidate : candidates)
+        candidate.count /= 2;
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+class Directory;
+class Directory_Entry;
+
+/**
+    Approximate access counts for files and directories, keyed by first cluster.
+
+    Counts live in a count-min sketch of relaxed atomic counters: recording never locks, an estimate
+    never undercounts, and the memory stays fixed however many entries the disk holds. Every
+    DECAY_INTERVAL accesses all counts are halved, so an entry stays hot only while it keeps being
+    used. Beside the sketch, the CANDIDATES entries with the highest counts are kept with their paths
+    for `hot`.
+
+    Only accesses a command makes through Directory::getSubDirectory, getContent/setContent and
+    File_Entry::readFileContent are recorded, on the command thread. Dir_Warmup and Dir_Prefetch go
+    to Dir_Cache directly and are not counted, and neither is anything inside a Bulk_Scope.
+
+    Dir_Cache and Content_Cache keep hot entries (isHot) when they evict, up to half their budget.
+*/
+class Access_Stats
+{
+public:
+    static const int DEPTH = 4;
+    /** Counters per row; a power of two. */
+    static const int WIDTH = 1024;
+    static const uint32_t DECAY_INTERVAL = 4096;
+    /** Estimated accesses (after decay) from which an entry counts as hot. */
+    static const uint32_t HOT_THRESHOLD = 8;
+    static const size_t CANDIDATES = 32;
+
+    struct Hot_Entry
+    {
+        int cluster = 0;
+        string path;
+        bool directory = false;
+        uint32_t count = 0;
+    };
+
+    /** Counts one access to `entry`, a record held by `parent` (which may be nullptr). */
+    static void record(const Directory* parent, const Directory_Entry& entry);
+
+    /** Estimated recent accesses to the chain starting at `cluster`; never less than the true count. */
+    static uint32_t estimate(int cluster);
+
+    static bool isHot(int cluster);
+
+    /** Up to n of the most accessed entries, most accessed first. */
+    static vector<Hot_Entry> top(size_t n);
+
+    /**
+        While alive, record() on the constructing thread counts nothing. For walks that visit a whole
+        tree once (du, copying, importing or exporting a directory), which would otherwise make every
+        entry they pass look as used as the ones a user keeps coming back to. Scopes nest.
+    */
+    class Bulk_Scope
+    {
+    public:
+        Bulk_Scope();
+        ~Bulk_Scope();
+
+        Bulk_Scope(const Bulk_Scope&) = delete;
+        Bulk_Scope& operator=(const Bulk_Scope&) = delete;
+    };
+
+private:
+    static size_t slot(int row, int cluster);
+    static string pathOf(const Directory* parent, const string& name);
+    static bool endsWithName(const string& path, const string& name);
+    static void decay();
+
+    static atomic<uint32_t> sketch[DEPTH][WIDTH];
+    static atomic<uint32_t> events;
+    static vector<Hot_Entry> candidates;
+    static thread_local int bulkDepth;
+};
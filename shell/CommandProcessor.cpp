@@ -1,5 +1,10 @@
 #include "CommandProcessor.h"
+#include "Access_Stats.h"
+#include "Command_Arena.h"
 #include "Directory.h"
+#include "Dir_Cache.h"
+#include "Dir_Stream.h"
+#include "Dir_Transaction.h"
 #include"Mini_FAT.h"
 #include <algorithm>
 #include <cstring>
@@ -12,6 +17,7 @@
 #include "Parser.h"
 #include <fstream>    // For file I/O
 #include <filesystem>
+#include <memory>
 namespace fs = std::filesystem;
 
 
@@ -91,6 +97,35 @@ CommandProcessor::CommandProcessor(Directory** currentDirPtr)
         "  - Includes detailed statistics like file count, directory count, total used space, and free space."
     };
 
+    commandHelp["du"] = {
+        "Shows how much space a directory tree uses.",
+        "Usage:\n"
+        "  du\n"
+        "  du [directory_path]\n\n"
+        "Syntax:\n"
+        "  - Current directory: `du`\n"
+        "  - A specific directory: `du [directory_path]`\n\n"
+        "Description:\n"
+        "  - Lists each subdirectory with the files, directories, bytes and clusters below it.\n"
+        "  - Clusters include the directories' own clusters; totals are kept up to date as\n"
+        "    files and directories change, so repeated calls do not walk the tree again."
+    };
+
+    commandHelp["hot"] = {
+        "Lists the most accessed files and directories.",
+        "Usage:\n"
+        "  hot\n"
+        "  hot [count]\n\n"
+        "Syntax:\n"
+        "  - Top 10 entries: `hot`\n"
+        "  - Top N entries: `hot [N]`\n\n"
+        "Description:\n"
+        "  - Shows estimated recent accesses (reads, writes and path walks) per entry, most first.\n"
+        "  - Counts halve periodically, so entries drop off once they are no longer used.\n"
+        "  - du and whole-directory copy, import and export are not counted.\n"
+        "  - Entries marked hot are kept in the directory and content caches when they evict."
+    };
+
     commandHelp["del"] = {
         "Deletes one or more files.",
         "Usage:\n"
@@ -227,19 +262,23 @@ CommandProcessor::CommandProcessor(Directory** currentDirPtr)
 
 void CommandProcessor::processCommand(const string& input, bool& isRunning)
 {
+    // Temporaries of this command come from the arena and are released together when it returns
+    Command_Arena arena;
+
     // Trim spaces from the input
-    string trimmedInput = input;
-    trimmedInput.erase(0, trimmedInput.find_first_not_of(" \t\r\n")); // Trim leading spaces
-    trimmedInput.erase(trimmedInput.find_last_not_of(" \t\r\n") + 1); // Trim trailing spaces
+    string_view trimmedInput = input;
+    size_t first = trimmedInput.find_first_not_of(" \t\r\n");
+    trimmedInput = (first == string_view::npos) ? string_view() : trimmedInput.substr(first); // Trim leading spaces
+    trimmedInput = trimmedInput.substr(0, trimmedInput.find_last_not_of(" \t\r\n") + 1); // Trim trailing spaces
 
     // Add trimmed command to history
     if (!trimmedInput.empty())
     {
-        commandHistory.push_back(trimmedInput);
+        commandHistory.emplace_back(trimmedInput);
     }
 
     // Tokenize the trimmed input
-    vector<string> tokens = Tokenizer::tokenize(trimmedInput);
+    pmr::vector<string_view> tokens = Tokenizer::tokenize(trimmedInput, Command_Arena::resource());
 
     if (tokens.empty())
     {
@@ -247,7 +286,7 @@ void CommandProcessor::processCommand(const string& input, bool& isRunning)
     }
 
     // Parse tokens into command and arguments
-    Command cmd = Parser::parse(tokens);
+    Command cmd = Parser::parse(tokens, Command_Arena::resource());
 
     // Convert command name to lowercase for case-insensitive comparison
     transform(cmd.name.begin(), cmd.name.end(), cmd.name.begin(),
@@ -362,6 +401,40 @@ void CommandProcessor::processCommand(const string& input, bool& isRunning)
                 << "  dir [path]\n";
         }
     }
+    else if (cmd.name == "du")
+    {
+        if (cmd.arguments.empty())
+        {
+            handleDu("");
+        }
+        else if (cmd.arguments.size() == 1)
+        {
+            handleDu(cmd.arguments[0]);
+        }
+        else
+        {
+            cout << "Error: Invalid syntax for du command.\n";
+            cout << "Usage:\n"
+                << "  du\n"
+                << "  du [path]\n";
+        }
+    }
+    else if (cmd.name == "hot")
+    {
+        if (cmd.arguments.empty())
+        {
+            handleHot("");
+        }
+        else if (cmd.arguments.size() == 1)
+        {
+            handleHot(cmd.arguments[0]);
+        }
+        else
+        {
+            cout << "Error: Invalid syntax for hot command.\n";
+            cout << "Usage: hot [count]\n";
+        }
+    }
     else if (cmd.name == "import")
     {
         if (!cmd.arguments.empty())
@@ -475,10 +548,10 @@ void CommandProcessor::showGeneralHelp()
         count++;
     }
 }
-void CommandProcessor::showCommandHelp(const string& command)
+void CommandProcessor::showCommandHelp(string_view command)
 {
     // Convert command to lowercase to make help case-insensitive
-    string cmdLower = command;
+    string cmdLower(command);
     transform(cmdLower.begin(), cmdLower.end(), cmdLower.begin(),
         [](unsigned char c) { return tolower(c); });
 
@@ -513,10 +586,10 @@ void CommandProcessor::handleCls()
     // On Windows, use system("cls") to clear the screen
     system("cls");
 }
-void CommandProcessor::handleMd(const string& dirPath)
+void CommandProcessor::handleMd(string_view dirPath)
 {
     // Trim spaces from the input
-    string trimmedPath = dirPath;
+    string trimmedPath(dirPath);
     trimmedPath.erase(0, trimmedPath.find_first_not_of(" \t\r\n")); // Trim leading spaces
     trimmedPath.erase(trimmedPath.find_last_not_of(" \t\r\n") + 1); // Trim trailing spaces
 
@@ -562,28 +635,26 @@ void CommandProcessor::handleMd(const string& dirPath)
     }
 
     // 3. Check if a file or directory with the same name already exists
-    for (const auto& entry : parentDir->DirOrFiles)
+    int existingIndex = parentDir->searchDirectory(dirName); // Case-insensitive
+    if (existingIndex != -1)
     {
-        if (!entry.getIsFile()) // Ensure we're comparing directories
-        {
-            std::string existingName = entry.getName();
-            std::string newName = dirName;
-
-            // Convert both names to lowercase for comparison
-            std::transform(existingName.begin(), existingName.end(), existingName.begin(),
-                [](unsigned char c) { return std::tolower(c); });
-            std::transform(newName.begin(), newName.end(), newName.begin(),
-                [](unsigned char c) { return std::tolower(c); });
+        if (parentDir->DirOrFiles[existingIndex].getIsFile())
+            std::cout << "Error: A file named '" << dirName << "' already exists.\n";
+        else
+            std::cout << "Error: Directory '" << dirName << "' already exists.\n";
+        return;
+    }
 
-            if (existingName == newName)
-            {
-                std::cout << "Error: Directory '" << dirName << "' already exists.\n";
-                return;
-            }
-        }
+    // 4. Clean the directory name without altering case; nothing is allocated for a rejected name
+    string cleanedName = Directory_Entry::cleanTheName(dirName);
+    if (cleanedName.empty())
+    {
+        cout << "Error: Invalid directory name.\n";
+        return;
     }
 
-    // 4. Allocate a new cluster for the directory
+    // 5. Allocate a new cluster for the directory where its parent places subdirectories
+    Mini_FAT::Allocation_Hint near(parentDir->subdirectoryHint());
     int newCluster = Mini_FAT::getAvailableCluster();
     if (newCluster == -1)
     {
@@ -591,16 +662,9 @@ void CommandProcessor::handleMd(const string& dirPath)
         return;
     }
 
-    // 5. Initialize the new directory's FAT pointer
+    // 6. Initialize the new directory's FAT pointer and blank its cluster, which may hold old data
     Mini_FAT::setClusterPointer(newCluster, -1); // -1 indicates EOF
-
-    // 6. Clean the directory name without altering case
-    string cleanedName = Directory_Entry::cleanTheName(dirName);
-    if (cleanedName.empty())
-    {
-        cout << "Error: Invalid directory name.\n";
-        return;
-    }
+    Virtual_Disk::writeCluster(vector<char>(1024, 0), newCluster);
 
     // 7. Create a new Directory object
     Directory* newDir = new Directory(cleanedName, 0x10, newCluster, parentDir);
@@ -609,21 +673,18 @@ void CommandProcessor::handleMd(const string& dirPath)
     // 8. Create a Directory_Entry using the existing constructor
     Directory_Entry newDirEntry(cleanedName, 0x10, newCluster);
 
-    // 9. Manually assign the subDirectory pointer
-    newDirEntry.subDirectory = newDir;
-
-    // 10. Add the new directory entry to the parent directory's DirOrFiles
-    parentDir->DirOrFiles.push_back(newDirEntry);
+    // 9. Share the Directory object with later lookups through the directory cache
+    Dir_Cache::adopt(newDir);
 
-    // 11. Write the updated parent directory to the virtual disk (if applicable)
-    parentDir->writeDirectory();
+    // 10. Add the new directory entry to the parent and write it to the virtual disk
+    parentDir->addEntry(newDirEntry);
 
     cout << "Directory '" << cleanedName << "' created successfully.\n";
 }
 
 
 
-void CommandProcessor::handleRd(const vector<string>& directories)
+void CommandProcessor::handleRd(const Arguments& directories)
 {
     if (directories.empty()) {
         cout << "Error: Invalid syntax for rd command.\n";
@@ -631,6 +692,9 @@ void CommandProcessor::handleRd(const vector<string>& directories)
         return;
     }
 
+    // Every removal is committed to disk once, when the command ends
+    Dir_Transaction batch;
+
     // Iterate over each directory argument
     for (const auto& dirPath : directories) {
         // Confirm deletion
@@ -687,15 +751,17 @@ void CommandProcessor::handleRd(const vector<string>& directories)
         }
 
         // Check if the directory is empty
-        if (!dirEntry.subDirectory->isEmpty()) {
+        Directory* subDir = parentDir->getSubDirectory(dirEntry);
+        if (subDir != nullptr && !subDir->isEmpty()) {
             cout << "Error: Directory '" << dirPath << "' is not empty.\n";
             continue;
         }
 
-        // Proceed to delete the directory
-        delete dirEntry.subDirectory; // Free memory
-        parentDir->DirOrFiles.erase(parentDir->DirOrFiles.begin() + dirIndex);
-        parentDir->writeDirectory();
+        // Frees the directory's chain, then its record; the cache frees the object once nothing refers to it
+        if (subDir != nullptr)
+            subDir->deletDirectory();
+        else
+            parentDir->removeEntry(dirEntry);
 
         cout << "Directory '" << dirPath << "' deleted successfully.\n";
     }
@@ -728,7 +794,7 @@ void CommandProcessor::handleCd(const string& path)
     {
         if ((*currentDirectoryPtr)->parent != nullptr)
         {
-            *currentDirectoryPtr = (*currentDirectoryPtr)->parent;
+            changeDirectory((*currentDirectoryPtr)->parent);
             cout << "Changed directory to: " << (*currentDirectoryPtr)->getFullPath() << "\n";
         }
         else
@@ -762,7 +828,7 @@ void CommandProcessor::handleCd(const string& path)
         // Debugging Statements
 
         // Verify the drive letter matches (case-insensitive)
-        string traversalDrive = toUpper(traversalDir->name.substr(0, 2));
+        string traversalDrive = toUpper(traversalDir->getName().substr(0, 2));
         if (traversalDrive != drive)
         {
             cout << "Error: Drive '" << drive << "' not found.\n";
@@ -771,16 +837,9 @@ void CommandProcessor::handleCd(const string& path)
 
         // Update the path to remove the drive part
         // Example: "C:\omar\omar1" becomes "omar\omar1"
-        string updatedPath = path.substr(3); // Skip "C:\"
+        string_view updatedPath = string_view(path).substr(3); // Skip "C:\"
         // Split the updated path
-        vector<string> pathComponents;
-        string component;
-        stringstream ss(updatedPath);
-        while (getline(ss, component, '\\'))
-        {
-            if (!component.empty())
-                pathComponents.push_back(component);
-        }
+        pmr::vector<string_view> pathComponents = Tokenizer::splitPath(updatedPath, Command_Arena::resource());
 
         // Start traversing from the root
         for (const auto& dirName : pathComponents)
@@ -805,41 +864,32 @@ void CommandProcessor::handleCd(const string& path)
             else
             {
                 // Search for the specified subdirectory
-                int dirIndex = traversalDir->searchDirectory(dirName);
-                if (dirIndex == -1)
+                Directory_Entry subDirEntry;
+                if (!traversalDir->lookup(Directory_Entry::makeKey(dirName), subDirEntry))
                 {
                     cout << "Error: System cannot find the specified folder '" << dirName << "'.\n";
                     return;
                 }
 
-                // Get the Directory_Entry object
-                Directory_Entry* subDirEntry = &traversalDir->DirOrFiles[dirIndex];
-                if (subDirEntry->dir_attr != 0x10) // 0x10 indicates a directory
+                if (subDirEntry.dir_attr != 0x10) // 0x10 indicates a directory
                 {
                     cout << "Error: '" << dirName << "' is not a directory.\n";
                     return;
                 }
 
-                // Assign traversalDir to the existing subDirectory
-                traversalDir = subDirEntry->subDirectory;
+                // Directories passed through are not loaded; changeDirectory loads the last one
+                traversalDir = traversalDir->getSubDirectory(subDirEntry, false);
             }
         }
 
         // Update the current directory pointer to traversalDir
-        *currentDirectoryPtr = traversalDir;
+        changeDirectory(traversalDir);
         cout << "Changed directory to: " << (*currentDirectoryPtr)->getFullPath() << "\n";
         return;
     }
 
     // If the path is not absolute, split it normally
-    vector<string> pathComponents;
-    string componentNonAbsolute;
-    stringstream ssNonAbsolute(path);
-    while (getline(ssNonAbsolute, componentNonAbsolute, '\\'))
-    {
-        if (!componentNonAbsolute.empty())
-            pathComponents.push_back(componentNonAbsolute);
-    }
+    pmr::vector<string_view> pathComponents = Tokenizer::splitPath(path, Command_Arena::resource());
 
     // Traverse the path components
     bool errorOccurred = false;
@@ -867,35 +917,41 @@ void CommandProcessor::handleCd(const string& path)
         else
         {
             // Move to specified subdirectory
-            int dirIndex = traversalDir->searchDirectory(dirName);
-            if (dirIndex == -1)
+            Directory_Entry subDirEntry;
+            if (!traversalDir->lookup(Directory_Entry::makeKey(dirName), subDirEntry))
             {
                 cout << "Error: System cannot find the specified folder '" << dirName << "'.\n";
                 errorOccurred = true;
                 break;
             }
 
-            // Get the Directory_Entry object
-            Directory_Entry* subDirEntry = &traversalDir->DirOrFiles[dirIndex];
-            if (subDirEntry->dir_attr != 0x10) // 0x10 indicates a directory
+            if (subDirEntry.dir_attr != 0x10) // 0x10 indicates a directory
             {
                 cout << "Error: '" << dirName << "' is not a directory.\n";
                 errorOccurred = true;
                 break;
             }
 
-            // Assign traversalDir to the existing subDirectory
-            traversalDir = subDirEntry->subDirectory;
+            // Directories passed through are not loaded; changeDirectory loads the last one
+            traversalDir = traversalDir->getSubDirectory(subDirEntry, false);
         }
     }
 
     if (!errorOccurred)
     {
         // Update the current directory pointer to traversalDir
-        *currentDirectoryPtr = traversalDir;
+        changeDirectory(traversalDir);
         cout << "Changed directory to: " << (*currentDirectoryPtr)->getFullPath() << "\n";
     }
 }
+// Moves the shell's reference from the old current directory to the new one
+void CommandProcessor::changeDirectory(Directory* dir)
+{
+    dir->ensureLoaded();
+    Dir_Cache::acquire(dir);
+    Dir_Cache::release(*currentDirectoryPtr);
+    *currentDirectoryPtr = dir;
+}
 void CommandProcessor::handlePwd()
 {
 
@@ -923,7 +979,7 @@ void CommandProcessor::handleQuit(bool& isRunning)
     cout << "************************************************************************************************************************" << endl;
     isRunning = false; // Set the flag to false to terminate the shell loop
 }
-File_Entry* CommandProcessor::MoveToFile(string& path)
+unique_ptr<File_Entry> CommandProcessor::MoveToFile(string& path)
 {
     // Split the path to get directory path and file name
     size_t lastBackslash = path.find_last_of('\\');
@@ -960,28 +1016,15 @@ File_Entry* CommandProcessor::MoveToFile(string& path)
         return nullptr;
     }
 
-    // Assuming you have a File_Entry class that handles file content
-    File_Entry* file = new File_Entry(fileEntry, targetDir);
+    // Owned by the caller; the entry it was read from stays in targetDir
+    auto file = make_unique<File_Entry>(fileEntry, targetDir);
     file->readFileContent();
 
     return file;
 }
-Directory* CommandProcessor::MoveToDir(const std::string& path) {
-    // Make a local modifiable copy of the input path
-    std::string normalizedPath = path;
-
-    // Normalize path separators to '\\'
-    std::replace(normalizedPath.begin(), normalizedPath.end(), '/', '\\');
-
-    // Split the path by '\\'
-    std::vector<std::string> dirs;
-    std::stringstream ss(normalizedPath);
-    std::string token;
-    while (std::getline(ss, token, '\\')) {
-        if (!token.empty()) {
-            dirs.push_back(token);
-        }
-    }
+Directory* CommandProcessor::MoveToDir(std::string_view path, bool load) {
+    // Split the path by '\\', accepting '/' as well
+    pmr::vector<string_view> dirs = Tokenizer::splitPath(path, Command_Arena::resource(), "\\/");
 
     // Check if the path is empty
     if (dirs.empty()) {
@@ -994,7 +1037,7 @@ Directory* CommandProcessor::MoveToDir(const std::string& path) {
 
     // Handle root navigation (e.g., "C:")
     std::string rootDrive = toUpper(current->getDrive()) + ":";
-    if (toUpper(dirs[0]) == toUpper(rootDrive)) {
+    if (toUpper(string(dirs[0])) == toUpper(rootDrive)) {
         while (current->parent != nullptr) {
             current = current->parent; // Move to root
         }
@@ -1003,20 +1046,19 @@ Directory* CommandProcessor::MoveToDir(const std::string& path) {
 
     // Traverse the path
     for (const auto& dirName : dirs) {
-        int dirIndex = current->searchDirectory(dirName);
-        if (dirIndex == -1) {
+        Directory_Entry entry;
+        if (!current->lookup(Directory_Entry::makeKey(dirName), entry)) {
             std::cout << "Error: Directory '" << dirName << "' not found in '" << current->getFullPath() << "'.\n";
             return nullptr;
         }
 
-        Directory_Entry& entry = current->DirOrFiles[dirIndex];
         if (entry.dir_attr != 0x10) { // 0x10 represents directory attribute
             std::cout << "Error: '" << dirName << "' is not a directory.\n";
             return nullptr;
         }
 
-        // Move to the subdirectory
-        current = entry.subDirectory;
+        // Move to the subdirectory; only the one returned is loaded
+        current = current->getSubDirectory(entry, false);
         if (!current) {
             std::cout << "Error: Subdirectory '" << dirName << "' is not accessible.\n";
             return nullptr;
@@ -1025,9 +1067,11 @@ Directory* CommandProcessor::MoveToDir(const std::string& path) {
         std::cout << "Navigated to directory: " << current->getFullPath() << "\n";
     }
 
+    if (load)
+        current->ensureLoaded();
     return current;
 }
-void CommandProcessor::handleDir(const std::string& path)
+void CommandProcessor::handleDir(std::string_view path)
 {
     // 1. Determine which directory to list
     Directory* targetDir = *currentDirectoryPtr;
@@ -1046,7 +1090,7 @@ void CommandProcessor::handleDir(const std::string& path)
         }
     }
     else if (!path.empty()) {
-        Directory* resolvedDir = MoveToDir(path);
+        Directory* resolvedDir = MoveToDir(path, false);
         if (!resolvedDir) {
             // MoveToDir prints an error already
             return;
@@ -1054,63 +1098,43 @@ void CommandProcessor::handleDir(const std::string& path)
         targetDir = resolvedDir;
     }
 
-    // 2. Print header
+    // 2. Print header; the listing streams the directory rather than loading it
     std::cout << "Directory of " << targetDir->getFullPath() << "\n\n";
 
     int fileCount = 0;
     int dirCount = 0;
     long long totalSize = 0; // Sum of file sizes
 
-    std::vector<Directory_Entry> directories;
-    std::vector<Directory_Entry> files;
-
-    // 3. Separate directories and files
-    for (const auto& entry : targetDir->DirOrFiles) {
-        if (entry.dir_attr == 0x10) {
-            // Directory
-            // Optionally skip "." or ".." if stored
-            if (entry.getName() == "." || entry.getName() == "..") continue;
-            directories.push_back(entry);
-        }
-        else {
-            // File
-            files.push_back(entry);
-        }
-    }
-
-    // 4. Sort alphabetically by name
-    auto alphaSort = [](const Directory_Entry& a, const Directory_Entry& b) {
-        return a.getName() < b.getName();
-        };
-    std::sort(directories.begin(), directories.end(), alphaSort);
-    std::sort(files.begin(), files.end(), alphaSort);
-
-    // 5. Define column widths for formatting
+    // 3. Define column widths for formatting
     const int nameWidth = 40;
     const int sizeWidth = 15;
 
-    // 6. Print column headers
+    // 4. Print column headers
     std::cout << std::left << std::setw(nameWidth) << "Name"
         << std::right << std::setw(sizeWidth) << "Size\n";
     std::cout << std::left << std::setw(nameWidth) << "----"
         << std::right << std::setw(sizeWidth) << "----\n";
 
-    // 7. Display directories first
-    for (const auto& d : directories) {
+    // "." and ".." are skipped if stored
+    auto isListedDirectory = [](const Directory_Entry& entry) {
+        return entry.dir_attr == 0x10 && entry.getName() != "." && entry.getName() != "..";
+        };
+
+    auto printDirectory = [&](const Directory_Entry& d) {
         std::string name = d.getName();
         if (name.empty()) {
             name = "<No Directory Name>";
         }
-        std::string attr = "<DIR>";
+        const std::string_view attr = " <DIR>";
 
-        // Print directory entry
-        std::cout << std::left << std::setw(nameWidth) << (name + " " + attr)
+        // Print directory entry; the name and attribute are padded together to nameWidth
+        int pad = std::max(static_cast<int>(attr.size()), nameWidth - static_cast<int>(name.size()));
+        std::cout << name << std::left << std::setw(pad) << attr
             << std::right << std::setw(sizeWidth) << "-" << "\n";
         dirCount++;
-    }
+        };
 
-    // 8. Display files
-    for (const auto& f : files) {
+    auto printFile = [&](const Directory_Entry& f) {
         std::string name = f.getName();
         if (name.empty()) {
             name = "<No Name>.txt"; // Assuming it's a .txt file
@@ -1122,6 +1146,42 @@ void CommandProcessor::handleDir(const std::string& path)
             << std::right << std::setw(sizeWidth) << size << " bytes\n";
         fileCount++;
         totalSize += size;
+        };
+
+    // 5. Directories first, then files, each alphabetically by name ignoring case
+    Directory_Entry entry;
+    Dir_Stream stream(targetDir);
+    if (stream.sorted()) {
+        // Tree directories are already in that order: one pass per kind, printed as they are read
+        while (stream.next(entry)) {
+            if (isListedDirectory(entry))
+                printDirectory(entry);
+        }
+        Dir_Stream filePass(targetDir);
+        while (filePass.next(entry)) {
+            if (entry.dir_attr != 0x10)
+                printFile(entry);
+        }
+    }
+    else {
+        // A flat directory holds at most TREE_THRESHOLD records; collect them in the command arena and sort
+        pmr::vector<Directory_Entry> directories(Command_Arena::resource());
+        pmr::vector<Directory_Entry> files(Command_Arena::resource());
+        while (stream.next(entry)) {
+            if (entry.dir_attr != 0x10)
+                files.push_back(entry);
+            else if (isListedDirectory(entry))
+                directories.push_back(entry);
+        }
+        auto alphaSort = [](const Directory_Entry& a, const Directory_Entry& b) {
+            return a.key < b.key;
+            };
+        std::sort(directories.begin(), directories.end(), alphaSort);
+        std::sort(files.begin(), files.end(), alphaSort);
+        for (const auto& d : directories)
+            printDirectory(d);
+        for (const auto& f : files)
+            printFile(f);
     }
 
     // 9. Calculate free space (using your Mini_FAT methods)
@@ -1139,11 +1199,93 @@ void CommandProcessor::handleDir(const std::string& path)
 }
 
 
+void CommandProcessor::handleDu(std::string_view path)
+{
+    // A report on the tree, not a use of it
+    Access_Stats::Bulk_Scope bulk;
+    Directory* targetDir = *currentDirectoryPtr;
+    if (path == "..") {
+        if (targetDir->parent == nullptr) {
+            std::cout << "Error: Already at the root directory.\n";
+            return;
+        }
+        targetDir = targetDir->parent;
+    }
+    else if (!path.empty() && path != ".") {
+        targetDir = MoveToDir(path, false);
+        if (!targetDir)
+            return;
+    }
+
+    const int numberWidth = 10;
+    const int bytesWidth = 14;
+    auto printRow = [&](const Dir_Usage& u, const std::string& name) {
+        std::cout << std::right << std::setw(numberWidth) << u.files
+            << std::setw(numberWidth) << u.dirs
+            << std::setw(bytesWidth) << u.bytes
+            << std::setw(numberWidth) << u.clusters << "  " << name << "\n";
+        };
 
-void CommandProcessor::handleEcho(const std::string& filePath)
+    std::cout << "Usage of " << targetDir->getFullPath() << "\n\n";
+    std::cout << std::right << std::setw(numberWidth) << "Files" << std::setw(numberWidth) << "Dirs"
+        << std::setw(bytesWidth) << "Bytes" << std::setw(numberWidth) << "Clusters" << "  Name\n";
+
+    // Each subdirectory answers from its kept totals; only ones never counted are walked
+    pmr::vector<Directory_Entry> directories(Command_Arena::resource());
+    Directory_Entry entry;
+    Dir_Stream stream(targetDir);
+    while (stream.next(entry)) {
+        if (entry.dir_attr == 0x10 && entry.getName() != "." && entry.getName() != "..")
+            directories.push_back(entry);
+    }
+    if (!stream.sorted()) {
+        std::sort(directories.begin(), directories.end(), [](const Directory_Entry& a, const Directory_Entry& b) {
+            return a.key < b.key;
+            });
+    }
+    for (const auto& d : directories)
+        printRow(targetDir->getSubDirectory(d, false)->getTreeUsage(), d.getName());
+
+    printRow(targetDir->getUsage(), ". (this directory only)");
+    printRow(targetDir->getTreeUsage(), "Total");
+    std::cout << "\n" << Mini_FAT::getFreeClusters() << " of " << Mini_FAT::getTotalClusters()
+        << " clusters free\n";
+}
+
+void CommandProcessor::handleHot(std::string_view count)
+{
+    size_t limit = 10;
+    if (!count.empty())
+    {
+        if (count.find_first_not_of("0123456789") != std::string::npos || count.size() > 4)
+        {
+            std::cout << "Error: '" << count << "' is not a valid count.\n";
+            return;
+        }
+        limit = static_cast<size_t>(std::stoi(std::string(count)));
+    }
+
+    std::vector<Access_Stats::Hot_Entry> hot = Access_Stats::top(limit);
+    if (hot.empty())
+    {
+        std::cout << "No accesses recorded yet.\n";
+        return;
+    }
+
+    const int countWidth = 10;
+    std::cout << std::right << std::setw(countWidth) << "Accesses" << "  Type  Path\n";
+    for (const auto& entry : hot)
+    {
+        std::cout << std::right << std::setw(countWidth) << entry.count
+            << (entry.directory ? "  DIR   " : "  FILE  ") << entry.path
+            << (Access_Stats::isHot(entry.cluster) ? "  (hot)" : "") << "\n";
+    }
+}
+
+void CommandProcessor::handleEcho(std::string_view filePath)
 {
     // 1. Trim leading and trailing spaces from filePath
-    std::string trimmed = filePath;
+    std::string trimmed(filePath);
     trimmed.erase(0, trimmed.find_first_not_of(" \t\r\n")); // Trim leading spaces
     trimmed.erase(trimmed.find_last_not_of(" \t\r\n") + 1); // Trim trailing spaces
 
@@ -1193,31 +1335,16 @@ void CommandProcessor::handleEcho(const std::string& filePath)
     }
 
     // 7. Check for duplicates (case-insensitive comparison)
-    for (const auto& entry : parentDir->DirOrFiles) {
-        std::string existingName = entry.getName();
-        std::string newName = fileName;
-
-        // Convert both names to lowercase for comparison
-        std::transform(existingName.begin(), existingName.end(), existingName.begin(),
-            [](unsigned char c) { return std::tolower(c); });
-        std::transform(newName.begin(), newName.end(), newName.begin(),
-            [](unsigned char c) { return std::tolower(c); });
-
-        if (existingName == newName) {
-            std::cout << "Error: File '" << fileName << "' already exists.\n";
-            return;
-        }
+    if (parentDir->searchDirectory(fileName) != -1) {
+        std::cout << "Error: File '" << fileName << "' already exists.\n";
+        return;
     }
 
     // 8. Create the file entry with fileName, dir_attr = 0x00 (file)
     Directory_Entry newFileEntry(fileName, 0x00, /*firstCluster=*/0);
-    newFileEntry.setIsFile(true); // Mark as a file
 
-    // 9. Add the new file to the parent directory
-    parentDir->DirOrFiles.push_back(newFileEntry);
-
-    // 10. Persist changes
-    parentDir->writeDirectory();
+    // 9. Add the new file to the parent directory and persist it
+    parentDir->addEntry(newFileEntry);
 
     std::cout << "File '" << newFileEntry.getName() << "' created successfully.\n";
 }
@@ -1225,7 +1352,7 @@ void CommandProcessor::handleEcho(const std::string& filePath)
 
 
 
-void CommandProcessor::handleWrite(const string& filePath)
+void CommandProcessor::handleWrite(string_view filePath)
 {
     // 1. Parse the path to separate parent path and file name
     string parentPath;
@@ -1268,49 +1395,41 @@ void CommandProcessor::handleWrite(const string& filePath)
         return;
     }
 
-    // 4. Search for the file in the parent directory
-    bool fileFound = false;
-    string lowerFileName = toLower(fileName); // Convert input file name to lowercase
-
-    for (auto& entry : parentDir->DirOrFiles) // Iterate by reference
+    // 4. Search for the file in the parent directory (case-insensitive)
+    int fileIndex = parentDir->searchDirectory(fileName);
+    if (fileIndex == -1)
     {
-        if (toLower(entry.getName()) == lowerFileName) // Compare in lowercase
-        {
-            if (!entry.getIsFile())
-            {
-                cout << "Error: '" << fileName << "' is a directory, not a file.\n";
-                return;
-            }
-
-            // 5. Prompt user for input
-            cout << "Enter text to write to '" << fileName << "'. Type 'END' on a new line to finish.\n";
-
-            string line;
-            string newContent;
-            while (true)
-            {
-                getline(cin, line);
-                if (line == "END")
-                    break;
-                newContent += line + "\n";
-            }
+        cout << "Error: File '" << fileName << "' does not exist.\n";
+        return;
+    }
 
-            // 6. Update the content
-            entry.setContent(newContent);
+    Directory_Entry& entry = parentDir->DirOrFiles[fileIndex];
+    if (!entry.getIsFile())
+    {
+        cout << "Error: '" << fileName << "' is a directory, not a file.\n";
+        return;
+    }
 
-            // 7. Persist changes
-            parentDir->writeDirectory(); // Assuming this writes directory metadata to disk
+    // 5. Prompt user for input
+    cout << "Enter text to write to '" << fileName << "'. Type 'END' on a new line to finish.\n";
 
-            cout << "Content written to '" << fileName << "' successfully.\n";
-            fileFound = true;
+    string line;
+    string newContent;
+    while (true)
+    {
+        getline(cin, line);
+        if (line == "END")
             break;
-        }
+        newContent += line + "\n";
     }
 
-    if (!fileFound)
-    {
-        cout << "Error: File '" << fileName << "' does not exist.\n";
-    }
+    // 6. Update the content
+    parentDir->setContent(entry, newContent);
+
+    // 7. Persist changes
+    parentDir->writeSlot(fileIndex); // Rewrites just this file's record
+
+    cout << "Content written to '" << fileName << "' successfully.\n";
 }
 bool CommandProcessor::isValidFileName(const std::string& name) {
     if (name.empty() || name.length() > 11) {
@@ -1348,14 +1467,14 @@ bool CommandProcessor::isValidFileName(const std::string& name) {
 
     return true;
 }
-void CommandProcessor::handleType(const vector<string>& filePaths) {
+void CommandProcessor::handleType(const Arguments& filePaths) {
     if (filePaths.empty()) {
         cout << "Error: Invalid syntax for type command.\n";
         cout << "Usage: type [file_path]+ (one or more file paths)\n";
         return;
     }
 
-    for (const string& filePath : filePaths) {
+    for (const auto& filePath : filePaths) {
         // Parse the path to separate parent path and file name
         string parentPath;
         string fileName;
@@ -1385,35 +1504,27 @@ void CommandProcessor::handleType(const vector<string>& filePaths) {
             continue; // Proceed to the next file
         }
 
-        // Convert the file name to lowercase for case-insensitive comparison
-        string lowerFileName = toLower(fileName);
-
-        // Search for the file in the parent directory
-        bool fileFound = false;
-        for (const auto& entry : parentDir->DirOrFiles) {
-            if (toLower(entry.getName()) == lowerFileName) {
-                if (!entry.getIsFile()) {
-                    cout << "Error: '" << fileName << "' is a directory, not a file.\n";
-                    fileFound = true; // Mark as found to avoid general not found message
-                    break;
-                }
-
-                // File found, display its content
-                cout << "Content of '" << fileName << "':\n";
-                cout << entry.getContent() << "\n";
-                fileFound = true;
-                break;
-            }
+        // Search for the file in the parent directory (case-insensitive)
+        int fileIndex = parentDir->searchDirectory(fileName);
+        if (fileIndex == -1) {
+            cout << "Error: File '" << fileName << "' does not exist.\n";
+            continue;
         }
 
-        if (!fileFound) {
-            cout << "Error: File '" << fileName << "' does not exist.\n";
+        const Directory_Entry& entry = parentDir->DirOrFiles[fileIndex];
+        if (!entry.getIsFile()) {
+            cout << "Error: '" << fileName << "' is a directory, not a file.\n";
+            continue;
         }
+
+        // File found, display its content
+        cout << "Content of '" << fileName << "':\n";
+        cout << parentDir->getContent(entry) << "\n";
     }
 }
 
 
-void CommandProcessor::handleDel(const vector<string>& targets)
+void CommandProcessor::handleDel(const Arguments& targets)
 {
     if (targets.empty())
     {
@@ -1422,6 +1533,9 @@ void CommandProcessor::handleDel(const vector<string>& targets)
         return;
     }
 
+    // Every removal is committed to disk once, when the command ends
+    Dir_Transaction batch;
+
     for (const auto& target : targets)
     {
         Directory* parentDir = nullptr;
@@ -1486,35 +1600,34 @@ void CommandProcessor::handleDel(const vector<string>& targets)
                     continue;
                 }
 
-                // Delete all files in the directory
-                for (auto it = targetDir->DirOrFiles.begin(); it != targetDir->DirOrFiles.end();)
+                // Delete all files in the directory; removing an entry moves others around in
+                // DirOrFiles, so take the names first
+                vector<Short_Name> fileKeys;
+                for (const auto& entry : targetDir->DirOrFiles)
                 {
-                    if (it->dir_attr != 0x10) // Skip subdirectories
-                    {
-                        string fileName = it->getName();
-                        cout << "Are you sure you want to delete the file '" << fileName << "'? (y/n): ";
-                        cin >> confirmation;
-                        cin.ignore(numeric_limits<streamsize>::max(), '\n');
-
-                        if (tolower(confirmation) == 'y')
-                        {
-                            File_Entry file(*it, targetDir);
-                            file.deleteFile();
-                            cout << "File '" << fileName << "' deleted successfully.\n";
-                            it = targetDir->DirOrFiles.erase(it); // Remove from directory list
-                        }
-                        else
-                        {
-                            ++it;
-                        }
-                    }
-                    else
+                    if (entry.dir_attr != 0x10) // Skip subdirectories
+                        fileKeys.push_back(entry.key);
+                }
+
+                for (const auto& fileKey : fileKeys)
+                {
+                    int fileIndex = targetDir->searchDirectory(fileKey);
+                    if (fileIndex == -1)
+                        continue;
+                    string fileName = targetDir->DirOrFiles[fileIndex].getName();
+                    cout << "Are you sure you want to delete the file '" << fileName << "'? (y/n): ";
+                    cin >> confirmation;
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+                    if (tolower(confirmation) == 'y')
                     {
-                        ++it; // Skip subdirectories
+                        // Marks the record deleted in place; nothing else in the directory is rewritten
+                        File_Entry file(targetDir->DirOrFiles[fileIndex], targetDir);
+                        file.deleteFile();
+                        cout << "File '" << fileName << "' deleted successfully.\n";
                     }
                 }
 
-                targetDir->writeDirectory(); // Persist changes
                 cout << "All files in the directory '" << dirEntry->getName() << "' have been processed.\n";
             }
             else
@@ -1534,11 +1647,7 @@ void CommandProcessor::handleDel(const vector<string>& targets)
             {
                 File_Entry file(*dirEntry, parentDir);
                 file.deleteFile();
-                cout << "File '" << fileName << "' deleted successfully.\n";
-
-                // Remove from DirOrFiles and persist changes
-                parentDir->DirOrFiles.erase(parentDir->DirOrFiles.begin() + entryIndex);
-                parentDir->writeDirectory();
+                cout << "File '" << fileName << "' deleted successfully.\n"; // deleteFile already removed and persisted the entry
             }
             else
             {
@@ -1550,7 +1659,7 @@ void CommandProcessor::handleDel(const vector<string>& targets)
 
 
 
-void CommandProcessor::handleRename(const vector<string>& args)
+void CommandProcessor::handleRename(const Arguments& args)
 {
     if (args.size() != 2)
     {
@@ -1559,8 +1668,8 @@ void CommandProcessor::handleRename(const vector<string>& args)
         return;
     }
 
-    string filePath = args[0];
-    string newFileName = args[1];
+    string filePath(args[0]);
+    string newFileName(args[1]);
 
     // Validate that newFileName does not contain a path
     if (newFileName.find("\\") != string::npos || newFileName.find(":") != string::npos)
@@ -1609,23 +1718,22 @@ void CommandProcessor::handleRename(const vector<string>& args)
         return;
     }
 
-    // Check for duplicate file names in the directory
-    for (const auto& entry : targetDir->DirOrFiles)
+    // Check for duplicate file names in the directory (changing only the case of the same file is allowed)
+    int duplicateIndex = targetDir->searchDirectory(newFileName);
+    if (duplicateIndex != -1 && duplicateIndex != fileIndex)
     {
-        if (entry.getName() == newFileName)
-        {
-            cout << "Error: A duplicate file name exists in the directory.\n";
-            return;
-        }
+        cout << "Error: A duplicate file name exists in the directory.\n";
+        return;
     }
 
-    // Rename the file
-    fileEntry.assignDir_Name(newFileName);
-    targetDir->writeDirectory(); // Persist the change to the disk
+    // Rename the file; updatecontent re-keys the index and persists the change to the disk
+    Directory_Entry renamed = fileEntry;
+    renamed.assignDir_Name(newFileName);
+    targetDir->updatecontent(fileEntry, renamed);
 
     cout << "File '" << fileName << "' renamed to '" << newFileName << "' successfully.\n";
 }
-void CommandProcessor::handleCopy(const vector<string>& args)
+void CommandProcessor::handleCopy(const Arguments& args)
 {
     // **Case (1): Type copy alone**
     if (args.empty())
@@ -1635,8 +1743,11 @@ void CommandProcessor::handleCopy(const vector<string>& args)
         return;
     }
 
-    string sourcePath = args[0];
-    string destinationPath = args.size() > 1 ? args[1] : "";
+    string sourcePath(args[0]);
+    string destinationPath = args.size() > 1 ? string(args[1]) : "";
+
+    // Copying a directory adds many entries; write them out together when the command ends
+    Dir_Transaction batch;
 
     // **Parse the Source Path**
     Directory* sourceDir = nullptr;
@@ -1760,7 +1871,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
             {
                 // **Destination is a Directory**
                 destIsDirectory = true;
-                destinationDir = destinationDir->DirOrFiles[destIndex].subDirectory;
+                destinationDir = destinationDir->getSubDirectory(destinationDir->DirOrFiles[destIndex]);
                 destFileName = sourceName; // Copy with Same Name into Destination Directory
             }
         }
@@ -1770,6 +1881,13 @@ void CommandProcessor::handleCopy(const vector<string>& args)
             // **Case (13): Copy File into Destination Directory**
             // **Check if File Already Exists in Destination Directory**
             int existingIndex = destinationDir->searchDirectory(sourceName);
+            if (existingIndex != -1 && destinationDir == sourceDir && existingIndex == sourceIndex)
+            {
+                // **Case (3) & (4): Copying a File into the Directory That Holds It**
+                cout << "Error: The file cannot be copied onto itself.\n";
+                cout << "0 file(s) copied.\n";
+                return;
+            }
             if (existingIndex != -1)
             {
                 // **Case (14): Destination File Exists - Prompt for Overwrite**
@@ -1788,7 +1906,10 @@ void CommandProcessor::handleCopy(const vector<string>& args)
 
                 // **Overwrite Existing File**
                 Directory_Entry& existingEntry = destinationDir->DirOrFiles[existingIndex];
-                existingEntry = sourceEntry; // Assuming Shallow Copy is Sufficient
+                destinationDir->discardContent(existingEntry);
+                Directory_Entry replacement = sourceEntry;
+                destinationDir->adoptEntry(replacement, *sourceDir);
+                destinationDir->updatecontent(existingEntry, replacement);
                 cout << "File '" << sourceName << "' overwritten successfully in the destination directory.\n";
                 cout << "1 file(s) copied.\n";
                 return;
@@ -1806,6 +1927,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
                 return;
             }
 
+            destinationDir->adoptEntry(newFileEntry, *sourceDir);
             destinationDir->addEntry(newFileEntry);
             cout << "File '" << sourceName << "' copied successfully to the destination directory.\n";
             cout << "1 file(s) copied.\n";
@@ -1815,7 +1937,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
         {
             // **Destination is a File or Intended to be a File**
             // **Check for Self-Copy**
-            if (sourcePath == destinationPath)
+            if (sourcePath == destinationPath || (destinationDir == sourceDir && destIndex == sourceIndex))
             {
                 // **Case (3) & (4): Self-Copy Detected**
                 cout << "Error: The file cannot be copied onto itself.\n";
@@ -1842,7 +1964,10 @@ void CommandProcessor::handleCopy(const vector<string>& args)
 
                 // **Overwrite Existing File**
                 Directory_Entry& existingEntry = destinationDir->DirOrFiles[destIndex];
-                existingEntry = sourceEntry; // Assuming Shallow Copy is Sufficient
+                destinationDir->discardContent(existingEntry);
+                Directory_Entry replacement = sourceEntry;
+                destinationDir->adoptEntry(replacement, *sourceDir);
+                destinationDir->updatecontent(existingEntry, replacement);
                 cout << "File '" << destFileName << "' overwritten successfully.\n";
                 cout << "1 file(s) copied.\n";
                 return;
@@ -1860,6 +1985,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
                 return;
             }
 
+            destinationDir->adoptEntry(newFileEntry, *sourceDir);
             destinationDir->addEntry(newFileEntry);
             cout << "File '" << sourceName << "' copied successfully as '" << destFileName << "'.\n";
             cout << "1 file(s) copied.\n";
@@ -1917,7 +2043,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
             {
                 // **Destination is an Existing Directory**
                 destIsDirectory = true;
-                destinationDir = destinationDir->DirOrFiles[destIndex].subDirectory;
+                destinationDir = destinationDir->getSubDirectory(destinationDir->DirOrFiles[destIndex]);
             }
             else if (destIndex != -1 && destinationDir->DirOrFiles[destIndex].dir_attr != 0x10)
             {
@@ -1934,14 +2060,29 @@ void CommandProcessor::handleCopy(const vector<string>& args)
         }
 
         // **Iterate Through Source Directory Entries and Copy Files**
+        Access_Stats::Bulk_Scope bulk;
+        Directory* sourceSubDir = sourceDir->getSubDirectory(sourceEntry);
+        if (!sourceSubDir)
+        {
+            cout << "Error: Source directory '" << sourceName << "' is not accessible.\n";
+            return;
+        }
+
         int filesCopied = 0;
-        for (const auto& entry : sourceEntry.subDirectory->DirOrFiles)
+        for (const auto& entry : sourceSubDir->DirOrFiles)
         {
             if (entry.dir_attr == 0x00) // Only Copy Files
             {
                 string srcFileName = entry.getName();
                 int destIndex = destinationDir->searchDirectory(srcFileName);
 
+                if (destIndex != -1 && &destinationDir->DirOrFiles[destIndex] == &entry)
+                {
+                    // **Case (3) & (4): Destination Is the Source Directory Itself**
+                    cout << "Error: The file '" << srcFileName << "' cannot be copied onto itself.\n";
+                    continue;
+                }
+
                 if (destIndex != -1)
                 {
                     // **Case (14): Destination File Exists - Prompt for Overwrite**
@@ -1959,7 +2100,10 @@ void CommandProcessor::handleCopy(const vector<string>& args)
 
                     // **Overwrite Existing File**
                     Directory_Entry& existingEntry = destinationDir->DirOrFiles[destIndex];
-                    existingEntry = entry; // Assuming Shallow Copy is Sufficient
+                    destinationDir->discardContent(existingEntry);
+                    Directory_Entry replacement = entry;
+                    destinationDir->adoptEntry(replacement, *sourceSubDir);
+                    destinationDir->updatecontent(existingEntry, replacement);
                     cout << "File '" << srcFileName << "' overwritten successfully in destination directory.\n";
                     filesCopied++;
                     continue;
@@ -1976,6 +2120,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
                     continue;
                 }
 
+                destinationDir->adoptEntry(newFileEntry, *sourceSubDir);
                 destinationDir->addEntry(newFileEntry);
                 cout << "File '" << srcFileName << "' copied successfully to destination directory.\n";
                 filesCopied++;
@@ -1993,7 +2138,7 @@ void CommandProcessor::handleCopy(const vector<string>& args)
 }
 
 
-void CommandProcessor::handleImport(const std::vector<std::string>& args) {
+void CommandProcessor::handleImport(const Arguments& args) {
     // Check for correct number of arguments
     if (args.empty() || args.size() > 2) {
         // Syntax error
@@ -2002,8 +2147,8 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
         return;
     }
 
-    std::string source = args[0];
-    std::string destination = (args.size() == 2) ? args[1] : "";
+    std::string source(args[0]);
+    std::string destination = (args.size() == 2) ? std::string(args[1]) : "";
 
     // Resolve the source path using filesystem library
     fs::path sourcePath(source);
@@ -2039,8 +2184,12 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
     // Initialize import counter
     int importedFileCount = 0;
 
+    // Every imported file is committed to disk once, when the command ends
+    Dir_Transaction batch;
+
     // Handle if source is a directory: import all .txt files
     if (fs::is_directory(sourcePath)) {
+        Access_Stats::Bulk_Scope bulk;
         Directory* targetDir = *currentDirectoryPtr; // Start with current directory
 
         // Determine the target directory based on destination
@@ -2092,12 +2241,10 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
                     // Check if directory with the same name already exists in parent
                     bool dirExists = false;
                     Directory* existingDir = nullptr;
-                    for (const auto& entry : parentDir->DirOrFiles) {
-                        if (!entry.getIsFile() && toLower(entry.getName()) == toLower(dirName)) {
-                            dirExists = true;
-                            existingDir = entry.subDirectory;
-                            break;
-                        }
+                    int dirIndex = parentDir->searchDirectory(dirName);
+                    if (dirIndex != -1 && !parentDir->DirOrFiles[dirIndex].getIsFile()) {
+                        dirExists = true;
+                        existingDir = parentDir->getSubDirectory(parentDir->DirOrFiles[dirIndex]);
                     }
 
                     if (dirExists && existingDir != nullptr) {
@@ -2112,12 +2259,10 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
 
                         // Create a new Directory_Entry for the new directory
                         Directory_Entry newDirEntry(dirName, 0x10, 0);
-                        newDirEntry.setIsFile(false);          // Mark as directory
-                        newDirEntry.subDirectory = newDir;     // Link the Directory object
+                        Dir_Cache::adopt(newDir); // Share the Directory object through the cache
 
                         // Add the new directory entry to the parent directory
-                        parentDir->addEntry(newDirEntry);
-                        parentDir->writeDirectory();           // Persist changes
+                        parentDir->addEntry(newDirEntry);      // Persists the new record
 
                         targetDir = newDir;                    // Set the target directory to the newly created directory
                         std::cout << "Directory '" << destination << "' created successfully.\n";
@@ -2135,12 +2280,10 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
                 // Check if the directory already exists in the current directory
                 bool dirExists = false;
                 Directory* existingDir = nullptr;
-                for (const auto& entry : targetDir->DirOrFiles) {
-                    if (!entry.getIsFile() && toLower(entry.getName()) == toLower(dirName)) {
-                        dirExists = true;
-                        existingDir = entry.subDirectory;
-                        break;
-                    }
+                int dirIndex = targetDir->searchDirectory(dirName);
+                if (dirIndex != -1 && !targetDir->DirOrFiles[dirIndex].getIsFile()) {
+                    dirExists = true;
+                    existingDir = targetDir->getSubDirectory(targetDir->DirOrFiles[dirIndex]);
                 }
 
                 if (dirExists && existingDir != nullptr) {
@@ -2155,12 +2298,10 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
 
                     // Create a new Directory_Entry for the new directory
                     Directory_Entry newDirEntry(dirName, 0x10, 0);
-                    newDirEntry.setIsFile(false);          // Mark as directory
-                    newDirEntry.subDirectory = newDir;     // Link the Directory object
+                    Dir_Cache::adopt(newDir); // Share the Directory object through the cache
 
                     // Add the new directory entry to the target directory
-                    targetDir->addEntry(newDirEntry);
-                    targetDir->writeDirectory();           // Persist changes
+                    targetDir->addEntry(newDirEntry);      // Persists the new record
 
                     targetDir = newDir;                    // Set the target directory to the newly created directory
                     std::cout << "Directory '" << destination << "' created successfully.\n";
@@ -2194,16 +2335,9 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
                 }
 
                 // Check if the file already exists in the target directory
-                bool fileExists = false;
-                int existingFileIndex = -1;
-                for (size_t i = 0; i < targetDir->DirOrFiles.size(); ++i) {
-                    // Case-insensitive comparison
-                    if (toLower(targetDir->DirOrFiles[i].getName()) == toLower(fileName)) {
-                        fileExists = true;
-                        existingFileIndex = static_cast<int>(i);
-                        break;
-                    }
-                }
+                // Case-insensitive comparison through the precomputed name keys
+                int existingFileIndex = targetDir->searchDirectory(fileName);
+                bool fileExists = (existingFileIndex != -1);
 
                 if (fileExists) {
                     // Prompt to overwrite
@@ -2231,20 +2365,17 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
                 if (fileExists && existingFileIndex != -1) {
                     // Overwrite the existing file's content
                     Directory_Entry& existingEntry = targetDir->DirOrFiles[existingFileIndex];
-                    existingEntry.setContent(fileContent);
-                    existingEntry.setIsFile(true);      // Ensure it's marked as a file
+                    targetDir->setContent(existingEntry, fileContent);
                     existingEntry.dir_attr = 0x00;      // Ensure dir_attr is set correctly
-                    targetDir->writeDirectory();
+                    targetDir->writeSlot(existingFileIndex);
                     std::cout << "File '" << fileName << "' overwritten and imported successfully.\n";
                 }
                 else {
                     // Create a new file entry
-                    Directory_Entry newFile(fileName, 0x00, static_cast<int>(fileContent.size())); // attr=0x00 for file
-                    newFile.setIsFile(true);                      // Mark as file
+                    Directory_Entry newFile(fileName, 0x00, 0); // attr=0x00 for file; setContent allocates the chain
                     newFile.dir_attr = 0x00;                      // Ensure dir_attr is set correctly
-                    newFile.setContent(fileContent);              // Set file content and update size
-                    targetDir->addEntry(newFile);                 // Add to directory
-                    targetDir->writeDirectory();                   // Write changes
+                    targetDir->setContent(newFile, fileContent);  // Set file content and update size
+                    targetDir->addEntry(newFile);                 // Add to directory and persist the record
                     std::cout << "File '" << fileName << "' imported successfully.\n";
                     importedFileCount++;
                 }
@@ -2258,18 +2389,19 @@ void CommandProcessor::handleImport(const std::vector<std::string>& args) {
 
 
 
-void CommandProcessor::handleExport(const std::vector<std::string>& args) {
+void CommandProcessor::handleExport(const Arguments& args) {
     if (args.size() < 1 || args.size() > 2) {
         std::cout << "Error: Invalid syntax for export command.\n";
         std::cout << "Usage: export [source_file_or_directory] [destination_file_or_directory]\n";
         return;
     }
 
-    std::string sourcePath = args[0];
-    std::string destinationPath = (args.size() == 2) ? args[1] : fs::current_path().string();
+    std::string sourcePath(args[0]);
+    std::string destinationPath = (args.size() == 2) ? std::string(args[1]) : fs::current_path().string();
 
     Directory* currentDir = *currentDirectoryPtr;
     Directory_Entry* sourceEntry = nullptr;
+    Directory* sourceParent = currentDir;
 
     bool isSourceAbsolutePath = (sourcePath.length() >= 3 && isalpha(sourcePath[0]) && sourcePath[1] == ':' && (sourcePath[2] == '\\' || sourcePath[2] == '/'));
 
@@ -2291,6 +2423,7 @@ void CommandProcessor::handleExport(const std::vector<std::string>& args) {
         }
 
         sourceEntry = &resolvedDir->DirOrFiles[entryIndex];
+        sourceParent = resolvedDir;
     }
     else {
         int entryIndex = currentDir->searchDirectory(sourcePath);
@@ -2306,12 +2439,15 @@ void CommandProcessor::handleExport(const std::vector<std::string>& args) {
 
     // Check if source is a directory
     if (sourceEntry->dir_attr == 0x10) { // Directory
-        Directory sourceDir(sourceEntry->getName(), sourceEntry->dir_attr, sourceEntry->dir_firstCluster, currentDir);
-        sourceDir.readDirectory();
+        // Files are written out as the directory is read, without loading it
+        Access_Stats::Bulk_Scope bulk;
+        Directory* sourceDir = Dir_Cache::get(sourceParent, *sourceEntry, false);
+        Dir_Stream stream(sourceDir);
+        Directory_Entry entry;
 
-        for (const auto& entry : sourceDir.DirOrFiles) {
+        while (stream.next(entry)) {
             if (entry.dir_attr != 0x10) { // Export files only
-                File_Entry file(entry, &sourceDir);
+                File_Entry file(entry, sourceDir);
                 file.readFileContent();
 
                 std::string destinationFilePath = (fs::path(destinationPath) / entry.getName()).string();
@@ -2341,7 +2477,7 @@ void CommandProcessor::handleExport(const std::vector<std::string>& args) {
             }
         }
 
-        std::cout << "Total files exported from '" << sourceDir.getFullPath() << "': " << exportedFiles << "\n";
+        std::cout << "Total files exported from '" << sourceDir->getFullPath() << "': " << exportedFiles << "\n";
         return;
     }
 
@@ -3,7 +3,9 @@
 
 #include "File_Entry.h"
 #include <iostream>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include "Parser.h"    
@@ -25,26 +27,30 @@ public:
     std::string toUpper(const std::string& s);
 private:
     void showGeneralHelp();
-    void showCommandHelp(const string& command);
+    void showCommandHelp(string_view command);
     void handleCls();
-    void handleMd(const string& dirname);
-    void handleRd(const vector<string>& directories);
+    void handleMd(string_view dirname);
+    void handleRd(const Arguments& directories);
     void handleCd(const string& dirname);
     void handlePwd();
     void handleQuit(bool& isRunning);
     void handleHistory();
-    void handleDir(const string& path);
-    void handleEcho(const string& filePath);
-    void handleWrite(const string& filePath);
+    void handleDir(string_view path);
+    void handleDu(string_view path);
+    void handleHot(string_view count);
+    void handleEcho(string_view filePath);
+    void handleWrite(string_view filePath);
     bool isValidFileName(const string& name);
-    void handleType(const vector<string>& filePaths);
-    void handleDel(const vector<string>& targets);
-    void handleRename(const vector<string>& args);
-    void handleCopy(const vector<string>& args);
-    void handleExport(const vector<string>& args);
-    void handleImport(const std::vector<std::string>& args);
-    Directory* MoveToDir(const string& path);
-    File_Entry* MoveToFile(string& path);
+    void handleType(const Arguments& filePaths);
+    void handleDel(const Arguments& targets);
+    void handleRename(const Arguments& args);
+    void handleCopy(const Arguments& args);
+    void handleExport(const Arguments& args);
+    void handleImport(const Arguments& args);
+    void changeDirectory(Directory* dir);
+    // With load = false the directory is returned unloaded if it was not loaded already
+    Directory* MoveToDir(string_view path, bool load = true);
+    unique_ptr<File_Entry> MoveToFile(string& path);
     vector<string> commandHistory;
 
     unordered_map<string, pair<string, string>> commandHelp;
@@ -0,0 +1,23 @@
+#include "Command_Arena.h"
+using namespace std;
+
+int Command_Arena::depth = 0;
+alignas(max_align_t) char Command_Arena::buffer[Command_Arena::BUFFER_SIZE];
+pmr::monotonic_buffer_resource Command_Arena::arena(Command_Arena::buffer, Command_Arena::BUFFER_SIZE);
+
+Command_Arena::Command_Arena()
+{
+    depth++;
+}
+
+Command_Arena::~Command_Arena()
+{
+    // Back to the start of the buffer; heap blocks taken by a large command are returned
+    if (--depth == 0)
+        arena.release();
+}
+
+pmr::memory_resource* Command_Arena::resource()
+{
+    return &arena;
+}
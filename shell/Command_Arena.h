@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+using namespace std;
+
+/**
+    Monotonic memory for the temporaries of one shell command: tokens, parsed arguments, path
+    components and listing buffers.
+
+    Allocations are bumped out of a fixed buffer (then out of blocks from the heap if a command
+    needs more) and never freed one by one; everything is released at once when the outermost
+    Command_Arena goes out of scope. Declare one at the top of processCommand; nested ones join it.
+    Nothing allocated from resource() may outlive the command.
+*/
+class Command_Arena
+{
+public:
+    /** Bytes served before the arena falls back to the heap. */
+    static const size_t BUFFER_SIZE = 32 * 1024;
+
+    Command_Arena();
+    ~Command_Arena();
+
+    Command_Arena(const Command_Arena&) = delete;
+    Command_Arena& operator=(const Command_Arena&) = delete;
+
+    static pmr::memory_resource* resource();
+
+private:
+    static int depth;
+    alignas(max_align_t) static char buffer[BUFFER_SIZE];
+    static pmr::monotonic_buffer_resource arena;
+};
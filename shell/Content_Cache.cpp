@@ -0,0 +1,107 @@
+#include "Content_Cache.h"
+#include "Access_Stats.h"
+#include "Converter.h"
+#include "Mini_FAT.h"
+#include "Virtual_Disk.h"
+using namespace std;
+
+unordered_map<int, Content_Cache::Cached> Content_Cache::entries;
+list<int> Content_Cache::lru;
+size_t Content_Cache::budget = Content_Cache::DEFAULT_BUDGET;
+size_t Content_Cache::usage = 0;
+
+string Content_Cache::get(int firstCluster, int size)
+{
+    if (firstCluster <= 0 || size <= 0)
+        return "";
+
+    auto it = entries.find(firstCluster);
+    if (it != entries.end())
+    {
+        // Hit: move to the front of the LRU list
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+        return it->second.content;
+    }
+
+    string content = load(firstCluster, size);
+    put(firstCluster, content);
+    return content;
+}
+
+void Content_Cache::put(int firstCluster, const string& content)
+{
+    if (firstCluster <= 0)
+        return;
+    invalidate(firstCluster);
+
+    // A body larger than the whole budget is handed back but not kept
+    if (content.size() > budget)
+        return;
+
+    lru.push_front(firstCluster);
+    entries[firstCluster] = Cached{ content, lru.begin() };
+    usage += content.size();
+    evict();
+}
+
+void Content_Cache::invalidate(int firstCluster)
+{
+    auto it = entries.find(firstCluster);
+    if (it == entries.end())
+        return;
+    usage -= it->second.content.size();
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+}
+
+void Content_Cache::setBudget(size_t bytes)
+{
+    budget = bytes;
+    evict();
+}
+
+size_t Content_Cache::getBudget()
+{
+    return budget;
+}
+
+size_t Content_Cache::getUsage()
+{
+    return usage;
+}
+
+string Content_Cache::load(int firstCluster, int size)
+{
+    vector<char> ls;
+    int cluster = firstCluster;
+    // Stop once the file size is covered; the rest of the last cluster is padding
+    while (cluster != -1 && cluster != 0 && ls.size() < static_cast<size_t>(size))
+    {
+        vector<char> clusterData = Virtual_Disk::readCluster(cluster);
+        ls.insert(ls.end(), clusterData.begin(), clusterData.end());
+        cluster = Mini_FAT::getClusterPointer(cluster);
+    }
+    if (ls.size() > static_cast<size_t>(size))
+        ls.resize(size);
+    return Converter::BytesToString(ls);
+}
+
+// Least recently used first, passing over hot bodies (Access_Stats) while they fit in half the budget
+void Content_Cache::evict()
+{
+    size_t pinned = 0;
+    auto it = lru.end();
+    while (usage > budget && it != lru.begin())
+    {
+        --it;
+        size_t size = entries[*it].content.size();
+        if (Access_Stats::isHot(*it) && pinned + size <= budget / 2)
+        {
+            pinned += size;
+            continue;
+        }
+        int cluster = *it;
+        ++it;
+        invalidate(cluster);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <list>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+/** Size-bounded LRU cache of file bodies, keyed by the first cluster of each file's chain. */
+class Content_Cache
+{
+public:
+    /** Default memory budget for cached file bodies, in bytes. */
+    static const size_t DEFAULT_BUDGET = 256 * 1024;
+
+    /** Returns the first `size` bytes of the chain starting at firstCluster, reading it from disk on a miss. */
+    static string get(int firstCluster, int size);
+
+    /** Stores a body that has just been written to the chain starting at firstCluster. */
+    static void put(int firstCluster, const string& content);
+
+    /** Drops the cached body of a chain whose clusters are being freed or rewritten. */
+    static void invalidate(int firstCluster);
+
+    /** Sets the memory budget and evicts down to it. */
+    static void setBudget(size_t bytes);
+
+    static size_t getBudget();
+
+    /** Returns the number of bytes currently held. */
+    static size_t getUsage();
+
+private:
+    struct Cached
+    {
+        string content;
+        list<int>::iterator lruPos;
+    };
+
+    /** Reads the whole chain and trims it to the file size. */
+    static string load(int firstCluster, int size);
+
+    /** Evicts least recently used bodies until usage fits the budget; hot ones stay while they fit in half of it. */
+    static void evict();
+
+    static unordered_map<int, Cached> entries;
+    /** Most recently used chain first. */
+    static list<int> lru;
+    static size_t budget;
+    static size_t usage;
+};
@@ -1,4 +1,5 @@
 #include "Converter.h"
+#include <cstring>
 using namespace std;
 
 // Convert an integer to a 4-byte vector in little-endian format
@@ -16,13 +17,19 @@ vector<char> Converter::intToByte(int n)
 int Converter::byteToInt(vector<char> bytes)
 {
     int n = 0;
-    for (int i = 0; i < bytes.size(); ++i)
+    for (int i = 0; i < bytes.size() && i < 4; ++i)
     {
-        n = (n << 8) | (bytes[i] & 0xFF);
+        n |= (bytes[i] & 0xFF) << (i * 8);  // Place each byte back in its position
     }
     return n;
 }
 
+// Little-endian int at p, as byteToInt decodes it
+static int readInt(const char* p)
+{
+    return (p[0] & 0xFF) | ((p[1] & 0xFF) << 8) | ((p[2] & 0xFF) << 16) | ((p[3] & 0xFF) << 24);
+}
+
 // Convert an array of integers to a continuous byte array
 vector<char> Converter::intArrayToByteArray(int* ints, int size)
 {
@@ -60,84 +67,48 @@ vector<vector<char>> Converter::splitBytes(vector<char> bytes)
         int rem = bytes.size() % 1024;
         for (int i = 0; i < number_of_arrays; i++)
         {
-            vector<char> b;
-            for (int j = i * 1024, k = 0; k < 1024; j++, k++)
-            {
-                b.push_back(bytes[j]);
-            }
-            ls.push_back(b);
+            ls.push_back(vector<char>(bytes.begin() + i * 1024, bytes.begin() + (i + 1) * 1024));
         }
         if (rem > 0)
         {
-            vector<char> b1(1024);
-            for (int i = number_of_arrays * 1024, k = 0; k < rem;
-                i++, k++)
-            {
-                b1.push_back(bytes[i]);
-            }
-            for (int i = rem; i < 1024; i++)
-            {
-                b1.push_back(0);
-            }
+            vector<char> b1(bytes.begin() + number_of_arrays * 1024, bytes.end());
+            b1.resize(1024, 0);  // Pad the remainder of the last cluster with zeros
             ls.push_back(b1);
         }
     }
     else
     {
-        vector<char> b1(1024);
-        for (int i = 0; i < 1024; i++)
-        {
-            b1.push_back(0);
-        }
-        ls.push_back(b1);
+        ls.push_back(vector<char>(1024, 0));
     }
     return ls;
 }
 
 
+// Decode one 32-byte record: name[0..10], attr[11], empty[12..23], first cluster[24..27], size[28..31]
 Directory_Entry Converter::BytesToDirectory_Entry(vector<char> bytes)
 {
-    string name = "";
-    for (int i = 0; i < 11; i++)
-    {
-        name += bytes[i];
-    }
-    char attr = bytes[11];
-    char empty[12];
-    int j = 12;
-    for (int i = 0; i < 12; i++)
-    {
-        empty[i] = bytes[j];
-        j++;
-    }
-    vector<char> fc(4);
-    for (int i = 0; i < fc.size(); i++)
-    {
-        fc.push_back(bytes[j]);
-        j++;
-    }
-    int firstcluster = Converter::byteToInt(fc);
-    vector<char> sz(4);
-    for (int i = 0; i < sz.size(); i++)
-    {
-        sz.push_back(bytes[j]);
-        j++;
-    }
-    int filesize = Converter::byteToInt(sz);
-    Directory_Entry d(name, attr, firstcluster);
-    for (int i = 0; i < 12; i++)
-    {
-        d.dir_empty[i] = empty[i];
-    }
-    d.dir_fileSize = filesize;
+    return BytesToDirectory_Entry(bytes.data());
+}
+
+Directory_Entry Converter::BytesToDirectory_Entry(const char* record)
+{
+    Directory_Entry d;
+    memcpy(d.dir_name, record, 11);
+    d.dir_attr = record[11];
+    memcpy(d.dir_empty, record + 12, 12);
+    d.dir_firstCluster = readInt(record + 24);
+    d.dir_fileSize = readInt(record + 28);
+    d.refreshKey();
     return d;
 }
 
 
 
+// Encode one entry into its 32-byte on-disk record
 vector<char> Converter::Directory_EntryToBytes(Directory_Entry d)
 {
-    vector<char> bytes(32);
+    vector<char> bytes;
+    bytes.reserve(32);
     for (int j = 0; j < 11; j++)
     {
         bytes.push_back(d.dir_name[j]);
@@ -163,7 +134,8 @@ vector<char> Converter::Directory_EntryToBytes(Directory_Entry d)
 
 vector<char> Converter::Directory_EntriesToBytes(vector<Directory_Entry>d)
 {
-    vector<char> bytes(d.size() * 32);
+    vector<char> bytes;
+    bytes.reserve(d.size() * 32);
     for (int i = 0; i < d.size(); i++)
     {
         vector<char> b = Converter::Directory_EntryToBytes(d[i]);
@@ -172,20 +144,16 @@ vector<char> Converter::Directory_EntriesToBytes(vector<Directory_Entry>d)
     return bytes;
 }
 
+// Decode consecutive 32-byte records, stopping at the first unused slot (name starts with 0)
 vector<Directory_Entry> Converter::BytesToDirectory_Entries(vector<char>
     bytes)
 {
-    vector<Directory_Entry> DirsFiles(bytes.size() / 32);
-    for (int i = 0; i < bytes.size(); i += 32)
+    vector<Directory_Entry> DirsFiles;
+    for (int i = 0; i + 32 <= bytes.size(); i += 32)
     {
-        vector<char> b;
-        for (int j = i; j < (i + 32); j++)
-        {
-            b.push_back(bytes[j]);
-        }
-        if (b[0] == 0)
+        if (bytes[i] == 0)
             break;
-        DirsFiles.push_back(Converter::BytesToDirectory_Entry(b));
+        DirsFiles.push_back(Converter::BytesToDirectory_Entry(bytes.data() + i));
     }
     return DirsFiles;
 }
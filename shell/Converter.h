@@ -27,6 +27,9 @@ public:
     // Converts a byte vector to a Directory_Entry object
     static Directory_Entry BytesToDirectory_Entry( vector<char> bytes);
 
+    // Decodes the 32-byte record at `record` in place, without copying it out of its cluster buffer
+    static Directory_Entry BytesToDirectory_Entry(const char* record);
+
     // Converts a Directory_Entry object to a byte vector
     static vector<char> Directory_EntryToBytes( Directory_Entry d);
 
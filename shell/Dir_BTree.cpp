@@ -0,0 +1,510 @@
+#include "Dir_BTree.h"
+#include "Converter.h"
+#include "Mini_FAT.h"
+#include "Virtual_Disk.h"
+using namespace std;
+
+static const char TREE_MAGIC[4] = { 0x01, 'B', 'T', 'D' };
+
+bool Dir_BTree::isTree(const vector<char>& cluster)
+{
+    return cluster.size() >= 4 && memcmp(cluster.data(), TREE_MAGIC, 4) == 0;
+}
+
+vector<Directory_Entry> Dir_BTree::readAll(int root)
+{
+    vector<Directory_Entry> out;
+    collect(root, out);
+    return out;
+}
+
+bool Dir_BTree::build(const vector<Directory_Entry>& sorted, int rootCluster)
+{
+    int height = 0;
+    while (capacity(height) < static_cast<long long>(sorted.size()))
+        height++;
+    return buildLevel(sorted, 0, sorted.size(), height, rootCluster) != -1;
+}
+
+int Dir_BTree::clustersNeeded(int count)
+{
+    // Every leaf but the root holds at least MIN_DEGREE - 1 records, and there are fewer inner nodes than leaves
+    return 2 * (count / (MIN_DEGREE - 1)) + 1;
+}
+
+bool Dir_BTree::insert(int root, const Directory_Entry& d)
+{
+    Node x = readNode(root);
+    if (x.records.size() == MAX_KEYS)
+    {
+        // Split the root in place: its contents move to a new child so the root cluster stays put
+        int moved = allocNode();
+        if (moved == -1)
+            return false;
+        Node child = x;
+        child.cluster = moved;
+        Node newRoot;
+        newRoot.cluster = root;
+        newRoot.leaf = false;
+        newRoot.children.push_back(moved);
+        if (!splitChild(newRoot, 0, child))
+        {
+            freeNode(moved);
+            return false;
+        }
+        x = newRoot;
+    }
+
+    while (true)
+    {
+        int i = lowerBound(x, d.key);
+        if (x.leaf)
+        {
+            x.records.insert(x.records.begin() + i, d);
+            writeNode(x);
+            return true;
+        }
+        Node child = readNode(x.children[i]);
+        if (child.records.size() == MAX_KEYS)
+        {
+            // Split on the way down so the leaf always has room
+            if (!splitChild(x, i, child))
+                return false;
+            if (x.records[i].key < d.key)
+                child = readNode(x.children[i + 1]);
+        }
+        x = child;
+    }
+}
+
+bool Dir_BTree::remove(int root, const Short_Name& key)
+{
+    Node x = readNode(root);
+    bool removed = removeFrom(x, key);
+
+    Node top = readNode(root);
+    if (top.records.empty() && !top.leaf)
+    {
+        // Shrink in place: the only child moves up into the root cluster
+        Node child = readNode(top.children[0]);
+        int old = child.cluster;
+        child.cluster = root;
+        writeNode(child);
+        freeNode(old);
+    }
+    return removed;
+}
+
+bool Dir_BTree::update(int root, const Directory_Entry& d)
+{
+    Node x = readNode(root);
+    while (true)
+    {
+        int i = lowerBound(x, d.key);
+        if (i < static_cast<int>(x.records.size()) && x.records[i].key == d.key)
+        {
+            x.records[i] = d;
+            writeNode(x);
+            return true;
+        }
+        if (x.leaf)
+            return false;
+        x = readNode(x.children[i]);
+    }
+}
+
+// Binary search on the raw name fields of each node on the way down; only the record found is decoded
+bool Dir_BTree::find(int root, const Short_Name& key, Directory_Entry& out)
+{
+    int cluster = root;
+    while (true)
+    {
+        vector<char> bytes = Virtual_Disk::readCluster(cluster);
+        int count = static_cast<unsigned char>(bytes[6]) | (static_cast<unsigned char>(bytes[7]) << 8);
+        if (count > MAX_KEYS)
+            count = MAX_KEYS;
+
+        int lo = 0;
+        int hi = count;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (Short_Name::fromDirName(bytes.data() + RECORDS_OFFSET + mid * 32).folded() < key)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        const char* record = bytes.data() + RECORDS_OFFSET + lo * 32;
+        if (lo < count && Short_Name::fromDirName(record).folded() == key)
+        {
+            out = Converter::BytesToDirectory_Entry(record);
+            return true;
+        }
+        if (bytes[4] != 0)
+            return false;
+        auto at = bytes.begin() + CHILDREN_OFFSET + lo * 4;
+        cluster = Converter::byteToInt(vector<char>(at, at + 4));
+    }
+}
+
+Dir_BTree::Cursor::Cursor(int root)
+{
+    descend(root);
+}
+
+// Pushes cluster and the leftmost path below it
+void Dir_BTree::Cursor::descend(int cluster)
+{
+    while (true)
+    {
+        Level level;
+        level.bytes = Virtual_Disk::readCluster(cluster);
+        level.count = static_cast<unsigned char>(level.bytes[6]) | (static_cast<unsigned char>(level.bytes[7]) << 8);
+        if (level.count > MAX_KEYS)
+            level.count = MAX_KEYS;
+        level.leaf = level.bytes[4] != 0;
+        path.push_back(move(level));
+        if (path.back().leaf)
+            return;
+        auto at = path.back().bytes.begin() + CHILDREN_OFFSET;
+        cluster = Converter::byteToInt(vector<char>(at, at + 4));
+    }
+}
+
+const char* Dir_BTree::Cursor::next()
+{
+    while (!path.empty())
+    {
+        Level& top = path.back();
+        if (top.pos == top.count)
+        {
+            path.pop_back();
+            continue;
+        }
+        // Moving a level keeps its buffer, so the record stays valid while the next subtree is pushed
+        const char* record = top.bytes.data() + RECORDS_OFFSET + top.pos * 32;
+        top.pos++;
+        if (!top.leaf)
+        {
+            auto at = top.bytes.begin() + CHILDREN_OFFSET + top.pos * 4;
+            descend(Converter::byteToInt(vector<char>(at, at + 4)));
+        }
+        return record;
+    }
+    return nullptr;
+}
+
+void Dir_BTree::freeBelowRoot(int root)
+{
+    Node x = readNode(root);
+    if (x.leaf)
+        return;
+    for (int child : x.children)
+    {
+        freeBelowRoot(child);
+        freeNode(child);
+    }
+}
+
+int Dir_BTree::countNodes(int root)
+{
+    Node x = readNode(root);
+    int count = 1;
+    if (!x.leaf)
+    {
+        for (int child : x.children)
+            count += countNodes(child);
+    }
+    return count;
+}
+
+Dir_BTree::Node Dir_BTree::readNode(int cluster)
+{
+    vector<char> bytes = Virtual_Disk::readCluster(cluster);
+    Node node;
+    node.cluster = cluster;
+    node.leaf = bytes[4] != 0;
+    int count = static_cast<unsigned char>(bytes[6]) | (static_cast<unsigned char>(bytes[7]) << 8);
+    if (count > MAX_KEYS)
+        count = MAX_KEYS;
+
+    node.records.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        node.records.push_back(Converter::BytesToDirectory_Entry(bytes.data() + RECORDS_OFFSET + i * 32));
+    }
+    if (!node.leaf)
+    {
+        node.children.reserve(count + 1);
+        for (int i = 0; i <= count; i++)
+        {
+            auto at = bytes.begin() + CHILDREN_OFFSET + i * 4;
+            node.children.push_back(Converter::byteToInt(vector<char>(at, at + 4)));
+        }
+    }
+    return node;
+}
+
+void Dir_BTree::writeNode(const Node& node)
+{
+    vector<char> bytes(1024, 0);
+    memcpy(bytes.data(), TREE_MAGIC, 4);
+    bytes[4] = node.leaf ? 1 : 0;
+    int count = static_cast<int>(node.records.size());
+    bytes[6] = static_cast<char>(count & 0xFF);
+    bytes[7] = static_cast<char>((count >> 8) & 0xFF);
+    for (size_t i = 0; i < node.children.size(); i++)
+    {
+        vector<char> c = Converter::intToByte(node.children[i]);
+        copy(c.begin(), c.end(), bytes.begin() + CHILDREN_OFFSET + i * 4);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        vector<char> r = Converter::Directory_EntryToBytes(node.records[i]);
+        copy(r.begin(), r.end(), bytes.begin() + RECORDS_OFFSET + i * 32);
+    }
+    Virtual_Disk::writeCluster(bytes, node.cluster);
+}
+
+int Dir_BTree::allocNode()
+{
+    int cluster = Mini_FAT::getAvailableCluster();
+    if (cluster != -1)
+        Mini_FAT::setClusterPointer(cluster, -1);
+    return cluster;
+}
+
+void Dir_BTree::freeNode(int cluster)
+{
+    Mini_FAT::setClusterPointer(cluster, 0);
+}
+
+// First record whose key is not less than `key`
+int Dir_BTree::lowerBound(const Node& node, const Short_Name& key)
+{
+    int lo = 0;
+    int hi = static_cast<int>(node.records.size());
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (node.records[mid].key < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Splits the full child at parent.children[i] around its median, which moves up into parent
+bool Dir_BTree::splitChild(Node& parent, int i, Node& child)
+{
+    int rightCluster = allocNode();
+    if (rightCluster == -1)
+        return false;
+
+    const int t = MIN_DEGREE;
+    Node right;
+    right.cluster = rightCluster;
+    right.leaf = child.leaf;
+    right.records.assign(child.records.begin() + t, child.records.end());
+    Directory_Entry median = child.records[t - 1];
+    if (!child.leaf)
+    {
+        right.children.assign(child.children.begin() + t, child.children.end());
+        child.children.resize(t);
+    }
+    child.records.resize(t - 1);
+
+    parent.records.insert(parent.records.begin() + i, median);
+    parent.children.insert(parent.children.begin() + i + 1, rightCluster);
+
+    writeNode(child);
+    writeNode(right);
+    writeNode(parent);
+    return true;
+}
+
+// Folds parent.records[i] and all of `right` into `left`, and frees right's cluster
+void Dir_BTree::mergeChildren(Node& parent, int i, Node& left, Node& right)
+{
+    left.records.push_back(parent.records[i]);
+    left.records.insert(left.records.end(), right.records.begin(), right.records.end());
+    if (!left.leaf)
+        left.children.insert(left.children.end(), right.children.begin(), right.children.end());
+    parent.records.erase(parent.records.begin() + i);
+    parent.children.erase(parent.children.begin() + i + 1);
+    freeNode(right.cluster);
+    writeNode(left);
+    writeNode(parent);
+}
+
+// Deletes key from the subtree at x; every node it descends into first gets at least MIN_DEGREE records
+bool Dir_BTree::removeFrom(Node& x, const Short_Name& key)
+{
+    const int t = MIN_DEGREE;
+    int n = static_cast<int>(x.records.size());
+    int i = lowerBound(x, key);
+
+    if (i < n && x.records[i].key == key)
+    {
+        if (x.leaf)
+        {
+            x.records.erase(x.records.begin() + i);
+            writeNode(x);
+            return true;
+        }
+
+        Node left = readNode(x.children[i]);
+        if (static_cast<int>(left.records.size()) >= t)
+        {
+            // Replace with the predecessor, then delete that from the left subtree
+            Node p = left;
+            while (!p.leaf)
+                p = readNode(p.children.back());
+            Directory_Entry pred = p.records.back();
+            x.records[i] = pred;
+            writeNode(x);
+            return removeFrom(left, pred.key);
+        }
+        Node right = readNode(x.children[i + 1]);
+        if (static_cast<int>(right.records.size()) >= t)
+        {
+            Node s = right;
+            while (!s.leaf)
+                s = readNode(s.children.front());
+            Directory_Entry succ = s.records.front();
+            x.records[i] = succ;
+            writeNode(x);
+            return removeFrom(right, succ.key);
+        }
+        mergeChildren(x, i, left, right);
+        return removeFrom(left, key);
+    }
+
+    if (x.leaf)
+        return false;
+
+    Node c = readNode(x.children[i]);
+    if (static_cast<int>(c.records.size()) < t)
+    {
+        Node left;
+        Node right;
+        bool hasLeft = i > 0;
+        bool hasRight = i < n;
+        if (hasLeft)
+            left = readNode(x.children[i - 1]);
+        if (hasLeft && static_cast<int>(left.records.size()) >= t)
+        {
+            // Borrow from the left sibling through the separator
+            c.records.insert(c.records.begin(), x.records[i - 1]);
+            x.records[i - 1] = left.records.back();
+            left.records.pop_back();
+            if (!c.leaf)
+            {
+                c.children.insert(c.children.begin(), left.children.back());
+                left.children.pop_back();
+            }
+            writeNode(left);
+            writeNode(c);
+            writeNode(x);
+        }
+        else
+        {
+            if (hasRight)
+                right = readNode(x.children[i + 1]);
+            if (hasRight && static_cast<int>(right.records.size()) >= t)
+            {
+                // Borrow from the right sibling through the separator
+                c.records.push_back(x.records[i]);
+                x.records[i] = right.records.front();
+                right.records.erase(right.records.begin());
+                if (!c.leaf)
+                {
+                    c.children.push_back(right.children.front());
+                    right.children.erase(right.children.begin());
+                }
+                writeNode(right);
+                writeNode(c);
+                writeNode(x);
+            }
+            else if (hasRight)
+            {
+                mergeChildren(x, i, c, right);
+            }
+            else
+            {
+                mergeChildren(x, i - 1, left, c);
+                c = left;
+            }
+        }
+    }
+    return removeFrom(c, key);
+}
+
+// Builds a subtree of exactly `height` over sorted[from, to), spreading records evenly so every
+// non-root node ends up at least half full; returns its cluster or -1 if the disk filled up
+int Dir_BTree::buildLevel(const vector<Directory_Entry>& sorted, size_t from, size_t to, int height, int cluster)
+{
+    if (cluster == -1)
+    {
+        cluster = allocNode();
+        if (cluster == -1)
+            return -1;
+    }
+
+    Node node;
+    node.cluster = cluster;
+    if (height == 0)
+    {
+        node.leaf = true;
+        node.records.assign(sorted.begin() + from, sorted.begin() + to);
+        writeNode(node);
+        return cluster;
+    }
+
+    node.leaf = false;
+    long long count = static_cast<long long>(to - from);
+    long long childCapacity = capacity(height - 1);
+    long long k = max(2LL, (count + 1 + childCapacity) / (childCapacity + 1));
+    long long childTotal = count - (k - 1);
+
+    size_t pos = from;
+    for (long long c = 0; c < k; c++)
+    {
+        size_t size = static_cast<size_t>(childTotal / k + (c < childTotal % k ? 1 : 0));
+        int child = buildLevel(sorted, pos, pos + size, height - 1, -1);
+        if (child == -1)
+            return -1;
+        node.children.push_back(child);
+        pos += size;
+        if (c < k - 1)
+            node.records.push_back(sorted[pos++]);
+    }
+    writeNode(node);
+    return cluster;
+}
+
+// Records a full tree of the given height holds
+long long Dir_BTree::capacity(int height)
+{
+    long long cap = MAX_KEYS;
+    for (int h = 0; h < height; h++)
+        cap = MAX_KEYS + (MAX_KEYS + 1) * cap;
+    return cap;
+}
+
+void Dir_BTree::collect(int cluster, vector<Directory_Entry>& out)
+{
+    Node x = readNode(cluster);
+    if (x.leaf)
+    {
+        out.insert(out.end(), x.records.begin(), x.records.end());
+        return;
+    }
+    for (size_t i = 0; i < x.records.size(); i++)
+    {
+        collect(x.children[i], out);
+        out.push_back(x.records[i]);
+    }
+    collect(x.children.back(), out);
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "Directory_Entry.h"
+#include <vector>
+using namespace std;
+
+/**
+    On-disk B-tree of directory records ordered by their case-folded name key, used for
+    directories past Directory::TREE_THRESHOLD entries.
+
+    Every node is one cluster marked -1 in the FAT (nodes are not chained):
+      [0..3]   magic 01 'B' 'T' 'D' (a flat directory never starts with byte 0x01)
+      [4]      1 for a leaf
+      [6..7]   record count, little-endian
+      [16..]   MAX_KEYS + 1 child clusters, 4 bytes each
+      [128..]  up to MAX_KEYS 32-byte records
+
+    The root node never moves, so the directory's first cluster (and its record in the parent)
+    stays the same as the tree grows and shrinks. Operations read and write O(log n) clusters;
+    the caller flushes the FAT afterwards.
+*/
+class Dir_BTree
+{
+public:
+    static const int MIN_DEGREE = 14;
+    static const int MAX_KEYS = 2 * MIN_DEGREE - 1;
+
+    /** True if the cluster holds a tree node rather than flat records. */
+    static bool isTree(const vector<char>& cluster);
+
+    /** All records, in key order. */
+    static vector<Directory_Entry> readAll(int root);
+
+    /** Builds a tree over sorted records with its root in rootCluster (already allocated). False if the disk filled up. */
+    static bool build(const vector<Directory_Entry>& sorted, int rootCluster);
+
+    /** Clusters a tree over `count` records needs at most. */
+    static int clustersNeeded(int count);
+
+    static bool insert(int root, const Directory_Entry& d);
+
+    static bool remove(int root, const Short_Name& key);
+
+    /** Overwrites the record with d's key in place. */
+    static bool update(int root, const Directory_Entry& d);
+
+    static bool find(int root, const Short_Name& key, Directory_Entry& out);
+
+    /** Frees every node except the root cluster, which is left to the caller. */
+    static void freeBelowRoot(int root);
+
+    static int countNodes(int root);
+
+    /** Walks the records of a tree in key order straight from disk, holding one node per level. */
+    class Cursor
+    {
+    public:
+        explicit Cursor(int root);
+
+        /** The next 32-byte record, or nullptr after the last; valid until the following call. */
+        const char* next();
+
+    private:
+        struct Level
+        {
+            vector<char> bytes;
+            int count = 0;
+            int pos = 0;
+            bool leaf = true;
+        };
+        vector<Level> path;
+
+        void descend(int cluster);
+    };
+
+private:
+    struct Node
+    {
+        int cluster = -1;
+        bool leaf = true;
+        vector<Directory_Entry> records;
+        vector<int> children;
+    };
+
+    static const int CHILDREN_OFFSET = 16;
+    static const int RECORDS_OFFSET = CHILDREN_OFFSET + 4 * (MAX_KEYS + 1);
+
+    static Node readNode(int cluster);
+    static void writeNode(const Node& node);
+    static int allocNode();
+    static void freeNode(int cluster);
+
+    static int lowerBound(const Node& node, const Short_Name& key);
+    static bool splitChild(Node& parent, int i, Node& child);
+    static void mergeChildren(Node& parent, int i, Node& left, Node& right);
+    static bool removeFrom(Node& node, const Short_Name& key);
+    static int buildLevel(const vector<Directory_Entry>& sorted, size_t from, size_t to, int height, int cluster);
+    static long long capacity(int height);
+    static void collect(int cluster, vector<Directory_Entry>& out);
+};
@@ -0,0 +1,285 @@
+#include "Dir_Cache.h"
+#include "Access_Stats.h"
+#include "Directory.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+using namespace std;
+
+unordered_map<Directory*, Dir_Cache::Cached> Dir_Cache::entries;
+unordered_map<int, Directory*> Dir_Cache::byCluster;
+unordered_map<string, Directory*> Dir_Cache::byPath;
+list<Directory*> Dir_Cache::lru;
+unordered_map<int, Directory::Usage_State> Dir_Cache::evictedUsage;
+size_t Dir_Cache::budget = Dir_Cache::DEFAULT_BUDGET;
+size_t Dir_Cache::peakUsage = 0;
+
+Directory* Dir_Cache::get(Directory* parent, const Directory_Entry& entry, bool load)
+{
+    // Empty directories have no chain, so those are found by path instead
+    Directory* dir = nullptr;
+    if (entry.dir_firstCluster != 0)
+    {
+        dir = findByCluster(entry.dir_firstCluster);
+    }
+    else
+    {
+        string path = parent->getFullPath();
+        if (!path.empty() && path.back() != '\\')
+            path += "\\";
+        dir = findByPath(path + entry.getName());
+    }
+
+    if (dir != nullptr)
+    {
+        if (dir->parent == parent && dir->dir_firstCluster == entry.dir_firstCluster)
+        {
+            touch(dir);
+            if (load)
+                dir->ensureLoaded();
+            return dir;
+        }
+        // Left over from an older layout of the disk
+        invalidate(dir);
+    }
+
+    dir = new Directory(entry, parent);
+    auto kept = evictedUsage.find(entry.dir_firstCluster);
+    if (kept != evictedUsage.end())
+    {
+        dir->usage = kept->second;
+        evictedUsage.erase(kept);
+    }
+    if (load)
+        dir->readDirectory();
+    else
+        dir->loaded = false;
+    adopt(dir);
+    return dir;
+}
+
+void Dir_Cache::adopt(Directory* dir)
+{
+    if (dir == nullptr || dir->parent == nullptr || entries.count(dir) != 0)
+        return;
+
+    string key = pathKey(dir->getFullPath());
+    auto old = byPath.find(key);
+    if (old != byPath.end())
+        invalidate(old->second);
+
+    lru.push_front(dir);
+    entries[dir] = Cached{ key, lru.begin() };
+    byPath[key] = dir;
+    if (dir->dir_firstCluster != 0)
+        byCluster[dir->dir_firstCluster] = dir;
+    // Keeps the parent (and so the whole path up to the root) alive while this directory is cached
+    acquire(dir->parent);
+}
+
+Directory* Dir_Cache::findByCluster(int firstCluster)
+{
+    auto it = byCluster.find(firstCluster);
+    return it == byCluster.end() ? nullptr : it->second;
+}
+
+Directory* Dir_Cache::findByPath(const string& fullPath)
+{
+    auto it = byPath.find(pathKey(fullPath));
+    return it == byPath.end() ? nullptr : it->second;
+}
+
+void Dir_Cache::moved(Directory* dir, int oldFirstCluster)
+{
+    if (entries.count(dir) == 0 || oldFirstCluster == dir->dir_firstCluster)
+        return;
+    auto it = byCluster.find(oldFirstCluster);
+    if (it != byCluster.end() && it->second == dir)
+        byCluster.erase(it);
+    if (dir->dir_firstCluster != 0)
+        byCluster[dir->dir_firstCluster] = dir;
+}
+
+void Dir_Cache::invalidate(Directory* dir)
+{
+    if (entries.count(dir) == 0)
+        return;
+    forget(dir);
+    dropUsage(dir->dir_firstCluster);
+    dir->removed = true;
+    // Still referenced (e.g. it is the current directory): release() frees it and its hold on the parent
+    if (dir->refCount == 0)
+    {
+        Directory* parent = dir->parent;
+        delete dir;
+        release(parent);
+    }
+}
+
+void Dir_Cache::dropUsage(int firstCluster)
+{
+    evictedUsage.erase(firstCluster);
+}
+
+void Dir_Cache::acquire(Directory* dir)
+{
+    if (dir != nullptr)
+        dir->refCount++;
+}
+
+void Dir_Cache::release(Directory* dir)
+{
+    if (dir == nullptr)
+        return;
+    dir->refCount--;
+    // A removed directory lives on only while the shell or a cached child still points at it
+    if (dir->refCount == 0 && dir->removed)
+    {
+        Directory* parent = dir->parent;
+        delete dir;
+        release(parent);
+    }
+}
+
+void Dir_Cache::trim(const Directory* keep)
+{
+    size_t usage = getUsage();
+    peakUsage = max(peakUsage, usage);
+
+    // Hot directories (Access_Stats) stay loaded, most recently used first, while they fit in half the budget
+    unordered_set<const Directory*> pinned;
+    size_t pinnedBytes = 0;
+    for (Directory* dir : lru)
+    {
+        if (usage <= budget)
+            break;
+        size_t size = footprint(dir);
+        if (Access_Stats::isHot(dir->dir_firstCluster) && pinnedBytes + size <= budget / 2)
+        {
+            pinned.insert(dir);
+            pinnedBytes += size;
+        }
+    }
+
+    bool evicted = true;
+    // Evicting a child can free its parent, so sweep again while that makes progress
+    while (usage > budget && evicted)
+    {
+        evicted = false;
+        auto it = lru.end();
+        while (usage > budget && it != lru.begin())
+        {
+            --it;
+            Directory* dir = *it;
+            if (dir->refCount != 0 || pinned.count(dir) != 0)
+                continue;
+            ++it;
+            usage -= footprint(dir);
+            Directory* parent = dir->parent;
+            dir->releaseSlack();
+            // Totals are cheap to keep and expensive to rebuild (a subtree walk)
+            if (dir->dir_firstCluster != 0 && (dir->usage.ownKnown || dir->usage.treeKnown))
+                evictedUsage[dir->dir_firstCluster] = dir->usage;
+            forget(dir);
+            delete dir;
+            release(parent);
+            evicted = true;
+        }
+    }
+
+    // Directories on the path to a cached child or to the current directory stay, but their entries need not
+    for (auto it = lru.rbegin(); usage > budget && it != lru.rend(); ++it)
+    {
+        Directory* dir = *it;
+        if (dir == keep || !dir->loaded || pinned.count(dir) != 0)
+            continue;
+        size_t before = footprint(dir);
+        dir->unload();
+        usage -= before - footprint(dir);
+    }
+}
+
+void Dir_Cache::releaseSlack()
+{
+    for (Directory* dir : lru)
+        dir->releaseSlack();
+}
+
+void Dir_Cache::clear()
+{
+    for (Directory* dir : lru)
+        delete dir;
+    lru.clear();
+    entries.clear();
+    byCluster.clear();
+    byPath.clear();
+    evictedUsage.clear();
+}
+
+void Dir_Cache::setBudget(size_t bytes)
+{
+    budget = bytes;
+}
+
+size_t Dir_Cache::getBudget()
+{
+    return budget;
+}
+
+size_t Dir_Cache::getUsage()
+{
+    size_t usage = 0;
+    for (Directory* dir : lru)
+        usage += footprint(dir);
+    return usage;
+}
+
+size_t Dir_Cache::getCount()
+{
+    return entries.size();
+}
+
+size_t Dir_Cache::getPeakUsage()
+{
+    return peakUsage;
+}
+
+string Dir_Cache::pathKey(const string& fullPath)
+{
+    string key = fullPath;
+    transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+    return key;
+}
+
+size_t Dir_Cache::footprint(const Directory* dir)
+{
+    return sizeof(Directory)
+        + dir->DirOrFiles.capacity() * sizeof(Directory_Entry)
+        + dir->diskSlots.capacity() * sizeof(int)
+        + dir->freeSlots.capacity() * sizeof(int)
+        + dir->nameIndex.capacity() * sizeof(int)
+        + dir->rawClusters.capacity() * sizeof(vector<char>) + dir->rawClusters.size() * 1024;
+}
+
+void Dir_Cache::touch(Directory* dir)
+{
+    auto it = entries.find(dir);
+    if (it != entries.end())
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+}
+
+// Unlinks dir from every index without freeing it
+void Dir_Cache::forget(Directory* dir)
+{
+    auto it = entries.find(dir);
+    if (it == entries.end())
+        return;
+    auto path = byPath.find(it->second.pathKey);
+    if (path != byPath.end() && path->second == dir)
+        byPath.erase(path);
+    auto cluster = byCluster.find(dir->dir_firstCluster);
+    if (cluster != byCluster.end() && cluster->second == dir)
+        byCluster.erase(cluster);
+    lru.erase(it->second.lruPos);
+    entries.erase(it);
+}
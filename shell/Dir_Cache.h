@@ -0,0 +1,101 @@
+#pragma once
+#include <list>
+#include <string>
+#include <unordered_map>
+#include "Directory.h"
+using namespace std;
+
+/**
+    Process-wide cache of loaded directories, keyed by first cluster and by full path, so every
+    resolver shares one Directory object per directory on disk.
+
+    Directories are reference counted: a cached child holds its parent, and the shell holds the
+    current directory. trim() runs between commands and evicts unreferenced directories, least
+    recently used first, until the estimated footprint fits the budget. If that is not enough,
+    directories that are still referenced are unloaded (see Directory::unload), so what stays
+    resident past the budget is one Directory object per referenced directory plus the current
+    directory's entries. The root is never cached.
+*/
+class Dir_Cache
+{
+public:
+    /** Default memory budget for cached directories, in bytes. */
+    static const size_t DEFAULT_BUDGET = 256 * 1024;
+
+    /**
+        Returns the child directory that `entry` names in `parent`, reading it from disk on a miss.
+        With load = false a miss is returned unloaded (see Directory::loaded), for passing through on a path.
+    */
+    static Directory* get(Directory* parent, const Directory_Entry& entry, bool load = true);
+
+    /** Registers a directory a command has just built (md, import) so later lookups share it. */
+    static void adopt(Directory* dir);
+
+    /** Cached directory whose chain starts at firstCluster, or nullptr. */
+    static Directory* findByCluster(int firstCluster);
+
+    /** Cached directory at a full path such as "C:\a\b" (case-insensitive), or nullptr. */
+    static Directory* findByPath(const string& fullPath);
+
+    /** Called by writeDirectory after the directory's chain was reallocated. */
+    static void moved(Directory* dir, int oldFirstCluster);
+
+    /** Drops a directory that was removed from disk; it is freed once nothing refers to it. */
+    static void invalidate(Directory* dir);
+
+    /** Forgets usage totals kept for an evicted directory whose chain started at firstCluster. */
+    static void dropUsage(int firstCluster);
+
+    static void acquire(Directory* dir);
+    static void release(Directory* dir);
+
+    /**
+        Evicts unreferenced directories, then unloads referenced ones other than `keep`, until usage
+        fits the budget. Hot directories (Access_Stats::isHot) are passed over while they fit in half
+        the budget. Call only between commands.
+    */
+    static void trim(const Directory* keep = nullptr);
+
+    /** Gives back the slack clusters of every cached directory (see Directory::releaseSlack); for shutdown. */
+    static void releaseSlack();
+
+    /** Frees every cached directory; for shutdown, after the shell released its current directory. */
+    static void clear();
+
+    /** Sets the memory budget; takes effect at the next trim(). */
+    static void setBudget(size_t bytes);
+
+    static size_t getBudget();
+
+    /** Returns the estimated bytes held by cached directories. */
+    static size_t getUsage();
+
+    static size_t getCount();
+
+    /** Highest usage seen by trim() before it evicted anything, i.e. at the end of the heaviest command. */
+    static size_t getPeakUsage();
+
+    /** Estimated bytes held by one directory, as counted against the budget. Touches only `dir`. */
+    static size_t footprint(const Directory* dir);
+
+private:
+    struct Cached
+    {
+        string pathKey;
+        list<Directory*>::iterator lruPos;
+    };
+
+    static string pathKey(const string& fullPath);
+    static void touch(Directory* dir);
+    static void forget(Directory* dir);
+
+    static unordered_map<Directory*, Cached> entries;
+    static unordered_map<int, Directory*> byCluster;
+    static unordered_map<string, Directory*> byPath;
+    /** Most recently used directory first. */
+    static list<Directory*> lru;
+    /** Usage totals of evicted directories, by first cluster, restored when they are read again. */
+    static unordered_map<int, Directory::Usage_State> evictedUsage;
+    static size_t budget;
+    static size_t peakUsage;
+};
@@ -0,0 +1,79 @@
+#include "Dir_Prefetch.h"
+#include "Dir_Cache.h"
+#include "Directory.h"
+#include "Virtual_Disk.h"
+using namespace std;
+
+Directory* Dir_Prefetch::parent = nullptr;
+vector<Dir_Prefetch::Job> Dir_Prefetch::jobs;
+thread Dir_Prefetch::worker;
+atomic<bool> Dir_Prefetch::cancelled(false);
+int Dir_Prefetch::limit = Dir_Prefetch::DEFAULT_LIMIT;
+
+void Dir_Prefetch::start(Directory* dir)
+{
+    finish();
+    if (limit <= 0 || dir == nullptr)
+        return;
+
+    dir->ensureLoaded();
+    for (const auto& entry : dir->DirOrFiles)
+    {
+        if (static_cast<int>(jobs.size()) >= limit)
+            break;
+        if (entry.dir_attr != 0x10 || entry.dir_firstCluster <= 0)
+            continue;
+        Directory* cached = Dir_Cache::findByCluster(entry.dir_firstCluster);
+        if (cached != nullptr && (cached->loaded || !cached->rawClusters.empty()))
+            continue;
+        Job job;
+        job.entry = entry;
+        jobs.push_back(job);
+    }
+    if (jobs.empty())
+        return;
+
+    parent = dir;
+    cancelled = false;
+    worker = thread(readAhead);
+}
+
+// Background thread: touches only the disk file, through its own handle, and its own jobs
+void Dir_Prefetch::readAhead()
+{
+    Virtual_Disk::Thread_Reader reader;
+    for (auto& job : jobs)
+    {
+        if (cancelled)
+            return;
+        job.cluster = Virtual_Disk::readCluster(job.entry.dir_firstCluster);
+        job.done = true;
+    }
+}
+
+void Dir_Prefetch::finish()
+{
+    if (!worker.joinable())
+        return;
+    cancelled = true;
+    worker.join();
+
+    for (auto& job : jobs)
+    {
+        if (!job.done)
+            break;
+        Dir_Cache::get(parent, job.entry, false)->primeFirstCluster(move(job.cluster));
+    }
+    jobs.clear();
+    parent = nullptr;
+}
+
+void Dir_Prefetch::setLimit(int children)
+{
+    limit = children;
+}
+
+int Dir_Prefetch::getLimit()
+{
+    return limit;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Directory_Entry.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace std;
+
+class Directory;
+
+/**
+    Reads ahead, on a background thread, the first cluster of each subdirectory of the directory the
+    shell has just moved to, so the next `dir` or `cd` into one of them does not wait for the disk.
+
+    The read runs only while the shell waits for input, when nothing writes to the disk: start() is
+    called after a command and finish() before the next one. finish() cancels whatever is left and
+    hands the clusters read so far to the subdirectories (see Directory::primeFirstCluster), which
+    Dir_Cache keeps unloaded until they are used. At most getLimit() subdirectories are read per
+    move, and ones already in memory are skipped.
+*/
+class Dir_Prefetch
+{
+public:
+    /** Default number of subdirectories read ahead per move. */
+    static const int DEFAULT_LIMIT = 32;
+
+    /** Starts reading ahead for the subdirectories of `dir`, cancelling a read still in progress. */
+    static void start(Directory* dir);
+
+    /** Stops the background read and hands over what it read. Safe to call when none is running. */
+    static void finish();
+
+    /** Sets the subdirectories read ahead per move; 0 turns read-ahead off. */
+    static void setLimit(int children);
+
+    static int getLimit();
+
+private:
+    struct Job
+    {
+        Directory_Entry entry;
+        vector<char> cluster;
+        bool done = false;
+    };
+
+    static void readAhead();
+
+    static Directory* parent;
+    static vector<Job> jobs;
+    static thread worker;
+    static atomic<bool> cancelled;
+    static int limit;
+};
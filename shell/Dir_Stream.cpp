@@ -0,0 +1,90 @@
+#include "Dir_Stream.h"
+#include "Directory.h"
+using namespace std;
+
+Dir_Stream::Dir_Stream(Directory* dir)
+    : dir(dir)
+{
+    if (dir->loaded)
+    {
+        inTree = dir->treeFormat;
+        return;
+    }
+
+    // An empty directory has no chain; the root keeps cluster 5 but frees it when empty
+    clusterNumber = dir->dir_firstCluster;
+    if (clusterNumber == 0 || Mini_FAT::getClusterPointer(clusterNumber) == 0)
+    {
+        done = true;
+        return;
+    }
+    cluster = Virtual_Disk::readCluster(clusterNumber);
+    if (Dir_BTree::isTree(cluster))
+    {
+        inTree = true;
+        vector<char>().swap(cluster);
+        tree = make_unique<Dir_BTree::Cursor>(clusterNumber);
+    }
+}
+
+bool Dir_Stream::next(Directory_Entry& out)
+{
+    if (done)
+        return false;
+
+    if (dir->loaded)
+    {
+        if (index == dir->DirOrFiles.size())
+        {
+            done = true;
+            return false;
+        }
+        out = dir->DirOrFiles[index++];
+        return true;
+    }
+
+    if (tree)
+    {
+        const char* bytes = tree->next();
+        if (bytes == nullptr)
+        {
+            done = true;
+            return false;
+        }
+        out = Converter::BytesToDirectory_Entry(bytes);
+        return true;
+    }
+
+    while (true)
+    {
+        if (record == Directory::ENTRIES_PER_CLUSTER)
+        {
+            // On to the next cluster of the chain
+            clusterNumber = Mini_FAT::getClusterPointer(clusterNumber);
+            if (clusterNumber <= 0)
+            {
+                done = true;
+                return false;
+            }
+            cluster = Virtual_Disk::readCluster(clusterNumber);
+            record = 0;
+        }
+        const char* bytes = cluster.data() + record * 32;
+        record++;
+        // The first unused slot ends the list; deleted records keep their slot
+        if (bytes[0] == 0)
+        {
+            done = true;
+            return false;
+        }
+        if (bytes[0] == Directory::DELETED_MARK)
+            continue;
+        out = Converter::BytesToDirectory_Entry(bytes);
+        return true;
+    }
+}
+
+bool Dir_Stream::sorted() const
+{
+    return inTree;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Dir_BTree.h"
+#include "Directory_Entry.h"
+#include <memory>
+#include <vector>
+using namespace std;
+
+class Directory;
+
+/**
+    opendir/readdir over one directory: next() yields its live records one at a time.
+
+    A loaded directory is walked in memory. Otherwise the records are read from disk as they are
+    needed, one cluster at a time for a flat chain and one node per level for a Dir_BTree, without
+    loading the directory, so memory stays constant however large it is and a caller can start on
+    the first records before the last cluster has been read. Tree directories come out in key
+    order (see sorted()); flat ones in disk order.
+
+    The directory must not change while a stream is open on it.
+*/
+class Dir_Stream
+{
+public:
+    explicit Dir_Stream(Directory* dir);
+
+    /** Copies the next record into out; false once every record has been returned. */
+    bool next(Directory_Entry& out);
+
+    /** True if records come out in Directory_Entry::key order. */
+    bool sorted() const;
+
+private:
+    Directory* dir;
+    bool done = false;
+    bool inTree = false;
+
+    // Loaded directory: position in DirOrFiles
+    size_t index = 0;
+
+    // Flat chain on disk: the current cluster and the next record in it
+    vector<char> cluster;
+    int clusterNumber = 0;
+    int record = 0;
+
+    unique_ptr<Dir_BTree::Cursor> tree;
+};
@@ -0,0 +1,30 @@
+#include "Dir_Transaction.h"
+#include "Mini_FAT.h"
+#include "Virtual_Disk.h"
+using namespace std;
+
+int Dir_Transaction::depth = 0;
+
+Dir_Transaction::Dir_Transaction()
+{
+    if (depth++ == 0)
+    {
+        Mini_FAT::beginDeferredWrites();
+        Virtual_Disk::beginBuffering();
+    }
+}
+
+Dir_Transaction::~Dir_Transaction()
+{
+    if (--depth == 0)
+    {
+        // The FAT goes into the buffer too, so everything reaches the file in one pass
+        Mini_FAT::endDeferredWrites();
+        Virtual_Disk::endBuffering();
+    }
+}
+
+bool Dir_Transaction::active()
+{
+    return depth > 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+using namespace std;
+
+/**
+    Groups the directory mutations of a multi-item command (del, rd, import, copy) into one commit.
+
+    While a transaction is open, adds, removes and updates change the Directory objects as usual, but
+    their record and cluster writes stay in memory (later reads see them) and FAT flushes are only
+    noted. When the outermost transaction ends, each touched cluster is written once and the FAT once.
+    Declare one at the top of a command; nested ones join the enclosing transaction.
+*/
+class Dir_Transaction
+{
+public:
+    Dir_Transaction();
+    ~Dir_Transaction();
+
+    Dir_Transaction(const Dir_Transaction&) = delete;
+    Dir_Transaction& operator=(const Dir_Transaction&) = delete;
+
+    static bool active();
+
+private:
+    static int depth;
+};
@@ -0,0 +1,102 @@
+#include "Dir_Warmup.h"
+#include "Dir_Cache.h"
+#include "Directory.h"
+#include "Virtual_Disk.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Unloaded Directory objects for the subdirectories of a directory that has just been read
+static void queueChildren(Directory* dir, vector<Directory*>& out)
+{
+    for (const auto& entry : dir->DirOrFiles)
+    {
+        if (entry.dir_attr != 0x10 || entry.getName() == "." || entry.getName() == "..")
+            continue;
+        Directory* child = new Directory(entry, dir);
+        child->loaded = false;
+        out.push_back(child);
+    }
+}
+
+Dir_Warmup::Result Dir_Warmup::run(Directory* root, int threads, chrono::milliseconds timeBudget, size_t memoryBudget)
+{
+    Result result;
+    if (threads <= 0)
+        return result;
+    memoryBudget = min(memoryBudget, Dir_Cache::getBudget());
+    auto deadline = chrono::steady_clock::now() + timeBudget;
+
+    mutex lock;
+    condition_variable changed;
+    deque<Directory*> queue;
+    // In the order they were read, so a parent always comes before its children
+    vector<Directory*> read;
+    int busy = 0;
+    bool stopped = false;
+
+    root->ensureLoaded();
+    vector<Directory*> first;
+    queueChildren(root, first);
+    queue.assign(first.begin(), first.end());
+
+    auto worker = [&]() {
+        Virtual_Disk::Thread_Reader reader;
+        unique_lock<mutex> guard(lock);
+        while (true)
+        {
+            changed.wait(guard, [&] { return stopped || !queue.empty() || busy == 0; });
+            if (stopped || queue.empty())
+                break;
+            Directory* dir = queue.front();
+            queue.pop_front();
+            busy++;
+            guard.unlock();
+
+            // Only this thread touches dir until it is handed back
+            dir->readDirectory();
+            dir->getUsage();
+            vector<Directory*> children;
+            queueChildren(dir, children);
+            size_t bytes = Dir_Cache::footprint(dir);
+
+            guard.lock();
+            busy--;
+            read.push_back(dir);
+            result.bytes += bytes;
+            if (result.bytes >= memoryBudget || chrono::steady_clock::now() >= deadline)
+            {
+                stopped = true;
+                for (Directory* child : children)
+                    delete child;
+            }
+            else
+            {
+                queue.insert(queue.end(), children.begin(), children.end());
+            }
+            changed.notify_all();
+        }
+    };
+
+    vector<thread> pool;
+    for (int i = 0; i < threads; i++)
+        pool.emplace_back(worker);
+    for (auto& t : pool)
+        t.join();
+
+    result.complete = !stopped && queue.empty();
+    for (Directory* dir : queue)
+        delete dir;
+    for (Directory* dir : read)
+        Dir_Cache::adopt(dir);
+    result.directories = read.size();
+
+    // Every directory is in memory, so the subtree totals for du add up without touching the disk
+    if (result.complete)
+        root->getTreeUsage();
+    return result;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+using namespace std;
+
+class Directory;
+
+/**
+    Optional mount step that reads the directory tree below the root ahead of the first command.
+
+    Worker threads take directories from a shared queue breadth first. Each worker reads a directory
+    with its own read-only disk handle (Virtual_Disk::Thread_Reader), builds its name index and usage,
+    and queues its subdirectories. Nothing shared is changed while they run: the directories are
+    handed to Dir_Cache on the calling thread afterwards, parents before children. The walk stops
+    early once the time budget has passed or the directories read reach the memory budget (never
+    more than Dir_Cache's own budget, past which they would be evicted after the first command).
+*/
+class Dir_Warmup
+{
+public:
+    struct Result
+    {
+        size_t directories = 0;
+        size_t bytes = 0;
+        /** True if the whole tree was read within the budgets. */
+        bool complete = false;
+    };
+
+    /** Call at mount, before any command and before anything writes to the disk. */
+    static Result run(Directory* root, int threads, chrono::milliseconds timeBudget, size_t memoryBudget);
+};
@@ -1,30 +1,75 @@
 #include "Directory.h"
+#include "Access_Stats.h"
+#include "Content_Cache.h"
+#include "Dir_BTree.h"
+#include "Dir_Cache.h"
+#include "Dir_Stream.h"
+#include "File_Entry.h"
+#include "Name_Scan.h"
+#include "Tokenizer.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
-#include <sstream>
 using namespace std;
 
+// Credits the clusters this directory's chain (or tree) gains or loses during one mutation to its usage.
+// Clusters credited by a nested change, such as the parent rewriting this directory's record, are left
+// out, so every cluster is counted once and only toward the directory whose chain it joined or left.
+class Directory::Chain_Change
+{
+public:
+    explicit Chain_Change(Directory* dir)
+        : dir(dir), freeBefore(Mini_FAT::getFreeClusters()), creditedBefore(credited)
+    {
+    }
+
+    ~Chain_Change()
+    {
+        long long used = freeBefore - Mini_FAT::getFreeClusters();
+        long long own = used - (credited - creditedBefore);
+        credited = creditedBefore + used;
+        if (own != 0)
+        {
+            Dir_Usage delta;
+            delta.clusters = own;
+            dir->applyUsage(delta, delta);
+        }
+    }
+
+private:
+    Directory* dir;
+    long long freeBefore;
+    long long creditedBefore;
+    static long long credited;
+};
+
+long long Directory::Chain_Change::credited = 0;
+
 Directory::Directory(string name, char dir_attr, int dir_firstCluster, Directory* pa)
     : Directory_Entry(name, dir_attr, dir_firstCluster)  
 {
     this-> parent = pa;
 }
 
+Directory::Directory(const Directory_Entry& d, Directory* pa)
+    : Directory_Entry(d)
+{
+    this->parent = pa;
+}
+
 
 Directory_Entry Directory::GetDirectory_Entry()
 {
-    Directory_Entry M(this->dir_name, this->dir_attr, this->dir_firstCluster);
-    for (int i = 0; i < 12; i++)
-    {
-        M.dir_empty[i] = this->dir_empty[i];
-    }
-    M.dir_fileSize = this->dir_fileSize;
+    // The record is plain data, so copy it as is (the name is not NUL-terminated)
+    Directory_Entry M = *this;
     return M;
 }
 
 int Directory::getmySizeOnDisk()
 {
+    ensureLoaded();
+    if (treeFormat)
+        return Dir_BTree::countNodes(dir_firstCluster);
     int size = 0;
     if (dir_firstCluster != 0)
     {
@@ -43,6 +88,7 @@ int Directory::getmySizeOnDisk()
 
 bool Directory::canAddEntry(Directory_Entry d)
 {
+    ensureLoaded();
     bool can = false;
     int neededSize = (DirOrFiles.size() + 1) * 32;
     int neededCluster = neededSize / 1024;
@@ -58,6 +104,14 @@ bool Directory::canAddEntry(Directory_Entry d)
 
 void Directory::emptymyClusters()
 {
+    Chain_Change chain(this);
+    ensureLoaded();
+    if (treeFormat)
+    {
+        Dir_BTree::freeBelowRoot(dir_firstCluster);
+        Mini_FAT::setClusterPointer(dir_firstCluster, 0);
+        return;
+    }
     if (this->dir_firstCluster != 0)
     {
         int cluster = this->dir_firstCluster;
@@ -74,82 +128,641 @@ void Directory::emptymyClusters()
     }
 }
 
+void Directory::addEntry(Directory_Entry d)
+{
+    Chain_Change chain(this);
+    Mini_FAT::Allocation_Hint near(metadataHint());
+    ensureLoaded();
+    size_t before = DirOrFiles.size();
+    insertEntry(d);
+    if (DirOrFiles.size() > before)
+    {
+        // A new subdirectory brings whatever it already holds (its first cluster, for md)
+        Dir_Usage subtree;
+        if (d.dir_attr == 0x10 && treeUsageTracked())
+            subtree = Dir_Cache::get(this, d, false)->getTreeUsage();
+        countRecord(d, 1, subtree);
+    }
+}
+
+void Directory::removeEntry(Directory_Entry d)
+{
+    Chain_Change chain(this);
+    int index = searchDirectory(d.key);
+    if (index == -1)
+        return;
+    Directory_Entry removed = DirOrFiles[index];
+    Dir_Usage subtree;
+    if (removed.dir_attr == 0x10 && treeUsageTracked())
+        subtree = Dir_Cache::get(this, removed, false)->getTreeUsage();
+    size_t before = DirOrFiles.size();
+    eraseEntry(d);
+    if (DirOrFiles.size() < before)
+    {
+        countRecord(removed, -1, subtree);
+        if (removed.dir_attr == 0x10)
+            Dir_Cache::dropUsage(removed.dir_firstCluster);
+    }
+}
+
 void Directory::updatecontent(Directory_Entry OLD, Directory_Entry New)
 {
-    readDirectory();
-    int index = searchDirectory(OLD.dir_name);
+    Chain_Change chain(this);
+    Mini_FAT::Allocation_Hint near(metadataHint());
+    int index = searchDirectory(OLD.key);
+    if (index == -1)
+        return;
+    Directory_Entry previous = DirOrFiles[index];
+    replaceEntry(OLD, New);
+    Dir_Usage delta = usageOf(New);
+    delta -= usageOf(previous);
+    applyUsage(delta, delta);
+}
+
+// Rewrites only the record that changed; this directory's own record, and so its ancestors, stay untouched
+void Directory::replaceEntry(Directory_Entry OLD, Directory_Entry New)
+{
+    int index = searchDirectory(OLD.key);
     if (index != -1)
     {
+        // A renamed directory changes the path of everything below it
+        if (New.dir_attr == 0x10 && New.key != OLD.key)
+            invalidatePaths();
+        if (treeFormat && New.key != OLD.key)
+        {
+            // A new name moves the record to another place in the tree and in the sorted entries
+            Dir_BTree::remove(dir_firstCluster, OLD.key);
+            DirOrFiles.erase(DirOrFiles.begin() + index);
+            DirOrFiles.insert(DirOrFiles.begin() + sortedPosition(New.key), New);
+            rebuildIndex();
+            if (!Dir_BTree::insert(dir_firstCluster, New))
+                writeDirectory();
+            Mini_FAT::writeFAT();
+            return;
+        }
         DirOrFiles[index] = New;
+        if (New.key != OLD.key)
+            rebuildIndex();
+        writeSlot(index);
+    }
+}
+
+// Cluster of this directory's chain that holds `slot`, or -1 if the chain does not reach it
+int Directory::clusterOfSlot(int slot) const
+{
+    int cluster = dir_firstCluster;
+    for (int i = 0; i < slot / ENTRIES_PER_CLUSTER && cluster > 0; i++)
+        cluster = Mini_FAT::getClusterPointer(cluster);
+    return cluster > 0 ? cluster : -1;
+}
+
+// Writes DirOrFiles[slot] over its 32 bytes on disk
+void Directory::writeSlot(int slot)
+{
+    if (treeFormat)
+    {
+        // Found by key in O(log n) nodes
+        if (!Dir_BTree::update(dir_firstCluster, DirOrFiles[slot]))
+            writeDirectory();
+        return;
+    }
+    int cluster = (slot < static_cast<int>(diskSlots.size())) ? clusterOfSlot(diskSlots[slot]) : -1;
+    if (cluster == -1)
+    {
+        // The chain does not match the entries in memory; rewrite it all
         writeDirectory();
+        return;
     }
+    Virtual_Disk::writeClusterBytes(Converter::Directory_EntryToBytes(DirOrFiles[slot]), cluster, (diskSlots[slot] % ENTRIES_PER_CLUSTER) * 32);
 }
 
-void Directory::removeEntry(Directory_Entry d)
+void Directory::eraseEntry(Directory_Entry d)
 {
-    auto it = find_if(DirOrFiles.begin(), DirOrFiles.end(), [&](const Directory_Entry& entry) {
-        return entry.getName() == d.getName();
-        });
-    if (it != DirOrFiles.end()) {
-        DirOrFiles.erase(it);
+    int index = searchDirectory(d.key);
+    if (index == -1)
+        return;
+
+    if (treeFormat)
+    {
+        // Sorted order has to hold, so every later slot moves down by one
+        DirOrFiles.erase(DirOrFiles.begin() + index);
+        rebuildIndex();
+        if (!DirOrFiles.empty())
+        {
+            Dir_BTree::remove(dir_firstCluster, d.key);
+            Mini_FAT::writeFAT();
+            return;
+        }
+        writeDirectory();
+        return;
+    }
+
+    int cluster = (index < static_cast<int>(diskSlots.size())) ? clusterOfSlot(diskSlots[index]) : -1;
+    if (DirOrFiles.size() == 1 || cluster == -1)
+    {
+        // The last entry frees the chain; a chain out of step with memory is rewritten
+        swapRemove(index);
         writeDirectory();
+        return;
     }
-    
+
+    // Mark the record deleted where it lies; the slot is reused by the next addEntry
+    int slot = diskSlots[index];
+    Virtual_Disk::writeClusterBytes(vector<char>(1, DELETED_MARK), cluster, (slot % ENTRIES_PER_CLUSTER) * 32);
+    swapRemove(index);
+    freeSlots.push_back(slot);
+    compactIfSparse();
 }
 
-void Directory::addEntry(Directory_Entry d)
+// Rewrites the chain without its deleted records once they fill at least a cluster and outnumber the live ones
+void Directory::compactIfSparse()
+{
+    if (freeSlots.size() >= ENTRIES_PER_CLUSTER && freeSlots.size() > DirOrFiles.size())
+        writeDirectory();
+}
+
+// Drops DirOrFiles[index] by moving the last entry into its place, so nothing else shifts and
+// nameIndex is patched in place instead of rebuilt
+void Directory::swapRemove(int index)
 {
+    int last = static_cast<int>(DirOrFiles.size()) - 1;
+    bool indexed = indexedCount == DirOrFiles.size() && !nameIndex.empty();
+    if (indexed)
+        unindexSlot(index);
+    if (index != last)
+    {
+        if (indexed)
+        {
+            size_t mask = nameIndex.size() - 1;
+            size_t pos = DirOrFiles[last].key.hash() & mask;
+            while (nameIndex[pos] != last + 1)
+                pos = (pos + 1) & mask;
+            nameIndex[pos] = index + 1;
+        }
+        DirOrFiles[index] = DirOrFiles[last];
+        if (index < static_cast<int>(diskSlots.size()) && last < static_cast<int>(diskSlots.size()))
+            diskSlots[index] = diskSlots[last];
+    }
+    DirOrFiles.pop_back();
+    if (diskSlots.size() > DirOrFiles.size())
+        diskSlots.resize(DirOrFiles.size());
+    if (!indexed)
+        rebuildIndex();
+}
+
+// Appends d and writes only its 32-byte slot; the chain grows by one blank cluster when the last one is full
+void Directory::insertEntry(Directory_Entry d)
+{
+    ensureLoaded();
+    if (treeFormat)
+    {
+        if (Dir_BTree::insert(dir_firstCluster, d))
+        {
+            DirOrFiles.insert(DirOrFiles.begin() + sortedPosition(d.key), d);
+            rebuildIndex();
+        }
+        Mini_FAT::writeFAT();
+        return;
+    }
+
+    if (diskSlots.size() != DirOrFiles.size())
+        writeDirectory();  // Slots out of step with memory; lay the chain out afresh
+
+    Directory_Entry A = this->GetDirectory_Entry();
+
+    // Fill a deleted slot first; otherwise append after the last slot in use
+    int slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<int>(DirOrFiles.size());
+    }
     DirOrFiles.push_back(d);
-    writeDirectory();
+    diskSlots.push_back(slot);
+    indexSlot(static_cast<int>(DirOrFiles.size()) - 1);
+
+    int cluster = clusterOfSlot(slot);
+    bool fatChanged = false;
+    if (cluster == -1)
+    {
+        // Only the first slot of a cluster may fall past the end of the chain
+        int previous = (slot == 0) ? -1 : clusterOfSlot(slot - 1);
+        if (slot % ENTRIES_PER_CLUSTER != 0 || (slot > 0 && previous == -1))
+        {
+            writeDirectory();
+            return;
+        }
+
+        // Right after the last cluster if it is free, so the chain stays contiguous
+        Mini_FAT::Allocation_Hint near(previous != -1 ? previous : metadataHint());
+        cluster = Mini_FAT::getAvailableCluster();
+        if (cluster == -1)
+        {
+            // Disk full: keep memory in step with the disk
+            DirOrFiles.pop_back();
+            diskSlots.pop_back();
+            rebuildIndex();
+            return;
+        }
+        Virtual_Disk::writeCluster(vector<char>(1024, 0), cluster);
+        Mini_FAT::setClusterPointer(cluster, -1);
+        if (previous != -1)
+        {
+            Mini_FAT::setClusterPointer(previous, cluster);
+            reserveSlack(cluster);
+        }
+        else
+        {
+            dir_firstCluster = cluster;
+        }
+        fatChanged = true;
+    }
+
+    Virtual_Disk::writeClusterBytes(Converter::Directory_EntryToBytes(d), cluster, (slot % ENTRIES_PER_CLUSTER) * 32);
+
+    // Only a new first cluster changes this directory's own record in the parent
+    if (dir_firstCluster != A.dir_firstCluster)
+    {
+        Dir_Cache::moved(this, A.dir_firstCluster);
+        if (this->parent != nullptr)
+            this->parent->updatecontent(A, this->GetDirectory_Entry());
+    }
+    if (fatChanged)
+        Mini_FAT::writeFAT();
+
+    if (DirOrFiles.size() > TREE_THRESHOLD)
+        convertToTree();
+}
+
+// A directory growing past its first cluster is likely in a burst of creations: link blank clusters
+// after `last` so the next records land without touching the FAT. releaseSlack gives them back
+void Directory::reserveSlack(int last)
+{
+    for (int i = 0; i < slackClusters && Mini_FAT::getAvailableClusters() > SLACK_MIN_FREE; i++)
+    {
+        int spare = Mini_FAT::getAvailableCluster();
+        Virtual_Disk::writeCluster(vector<char>(1024, 0), spare);
+        Mini_FAT::setClusterPointer(spare, -1);
+        Mini_FAT::setClusterPointer(last, spare);
+        last = spare;
+    }
+}
+
+void Directory::releaseSlack()
+{
+    if (!loaded || treeFormat || dir_firstCluster == 0 || diskSlots.size() != DirOrFiles.size())
+        return;
+    Chain_Change chain(this);
+    // Every cluster up to the one holding the highest live or deleted record stays
+    int highest = -1;
+    for (int slot : diskSlots)
+        highest = max(highest, slot);
+    for (int slot : freeSlots)
+        highest = max(highest, slot);
+    int last = clusterOfSlot(max(highest, 0));
+    if (last == -1)
+        return;
+    int cluster = Mini_FAT::getClusterPointer(last);
+    if (cluster <= 0)
+        return;
+    Mini_FAT::setClusterPointer(last, -1);
+    while (cluster > 0)
+    {
+        int next = Mini_FAT::getClusterPointer(cluster);
+        Mini_FAT::setClusterPointer(cluster, 0);
+        cluster = next;
+    }
+    Mini_FAT::writeFAT();
+}
+
+int Directory::slackClusters = Directory::DEFAULT_SLACK_CLUSTERS;
+
+int Directory::metadataHint() const
+{
+    if (dir_firstCluster > 0)
+        return dir_firstCluster;
+    return parent != nullptr ? parent->subdirectoryHint() : 0;
+}
+
+// Next to this directory while its group is at most half full. Top-level directories, and those
+// whose parent's group is filling up, start in the emptiest group so their files fit next to them
+int Directory::subdirectoryHint() const
+{
+    int home = metadataHint();
+    if (parent != nullptr && Mini_FAT::getGroupFree(home) * 2 >= Mini_FAT::GROUP_CLUSTERS)
+        return home;
+    return Mini_FAT::getEmptiestGroup(home);
+}
+
+int Directory::dataHint() const
+{
+    return metadataHint() + DATA_ZONE_GAP;
+}
+
+void Directory::setSlackClusters(int clusters)
+{
+    slackClusters = max(clusters, 0);
+}
+
+int Directory::getSlackClusters()
+{
+    return slackClusters;
+}
+
+// Switches a flat directory that grew past TREE_THRESHOLD to the B-tree format; the root node
+// takes over the first cluster, so the record in the parent does not change
+void Directory::convertToTree()
+{
+    int spare = getmySizeOnDisk() - 1;
+    if (Mini_FAT::getAvailableClusters() + spare < Dir_BTree::clustersNeeded(static_cast<int>(DirOrFiles.size())))
+        return; // Not enough room to rebuild; stay flat
+
+    stable_sort(DirOrFiles.begin(), DirOrFiles.end(), [](const Directory_Entry& a, const Directory_Entry& b) {
+        return a.key < b.key;
+        });
+    rebuildIndex();
+
+    int cluster = Mini_FAT::getClusterPointer(dir_firstCluster);
+    while (cluster > 0)
+    {
+        int next = Mini_FAT::getClusterPointer(cluster);
+        Mini_FAT::setClusterPointer(cluster, 0);
+        cluster = next;
+    }
+    Mini_FAT::setClusterPointer(dir_firstCluster, -1);
+
+    Dir_BTree::build(DirOrFiles, dir_firstCluster);
+    treeFormat = true;
+    diskSlots.clear();
+    freeSlots.clear();
+    Mini_FAT::writeFAT();
+}
+
+// Slot at which an entry with this key belongs in a tree directory's sorted entries
+int Directory::sortedPosition(const Short_Name& key) const
+{
+    auto it = lower_bound(DirOrFiles.begin(), DirOrFiles.end(), key, [](const Directory_Entry& e, const Short_Name& k) {
+        return e.key < k;
+        });
+    return static_cast<int>(it - DirOrFiles.begin());
 }
 
 void Directory::deletDirectory()
 {
     emptymyClusters();
+    Mini_FAT::writeFAT();
     if (this->parent != nullptr)
     {
         this->parent->removeEntry(GetDirectory_Entry());
     }
+    // May free this object, so it has to come last
+    Dir_Cache::invalidate(this);
 }
 
 int Directory::searchDirectory( string name)
 {
-    for (int i = 0; i < DirOrFiles.size(); i++)
+    return searchDirectory(Directory_Entry::makeKey(name));
+}
+
+// Case-insensitive: keys are lower-cased when the entry is built
+int Directory::searchDirectory(const Short_Name& key)
+{
+    ensureLoaded();
+    if (indexedCount != DirOrFiles.size())
+        rebuildIndex();
+    if (nameIndex.empty())
+        return -1;
+
+    size_t mask = nameIndex.size() - 1;
+    for (size_t pos = key.hash() & mask; nameIndex[pos] != 0; pos = (pos + 1) & mask)
     {
-        string entryName = DirOrFiles[i].getName();
-        if (entryName == name) // Case-sensitive comparison
-            return i;
+        int slot = nameIndex[pos] - 1;
+        if (DirOrFiles[slot].key == key)
+            return slot;
     }
     return -1;
 }
 
+// Sizes the table to at least twice the entry count (a power of two) and re-inserts every slot in order,
+// so a duplicated name still resolves to its first slot as the linear scan did
+void Directory::rebuildIndex()
+{
+    size_t capacity = 16;
+    while (capacity < DirOrFiles.size() * 2)
+        capacity *= 2;
+    nameIndex.assign(capacity, 0);
+    indexedCount = 0;
+    for (int i = 0; i < DirOrFiles.size(); i++)
+        indexSlot(i);
+}
+
+void Directory::indexSlot(int slot)
+{
+    if (nameIndex.empty() || (indexedCount + 1) * 2 > nameIndex.size() || indexedCount != static_cast<size_t>(slot))
+    {
+        rebuildIndex();
+        return;
+    }
+    size_t mask = nameIndex.size() - 1;
+    size_t pos = DirOrFiles[slot].key.hash() & mask;
+    while (nameIndex[pos] != 0)
+        pos = (pos + 1) & mask;
+    nameIndex[pos] = slot + 1;
+    indexedCount++;
+}
+
+// Takes slot out of nameIndex, shifting later members of its probe run back so no lookup stops early
+void Directory::unindexSlot(int slot)
+{
+    size_t mask = nameIndex.size() - 1;
+    size_t hole = DirOrFiles[slot].key.hash() & mask;
+    while (nameIndex[hole] != slot + 1)
+        hole = (hole + 1) & mask;
+    for (size_t next = (hole + 1) & mask; nameIndex[next] != 0; next = (next + 1) & mask)
+    {
+        size_t home = DirOrFiles[nameIndex[next] - 1].key.hash() & mask;
+        // An entry may move into the hole only if the hole lies between its home and where it sits
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            nameIndex[hole] = nameIndex[next];
+            hole = next;
+        }
+    }
+    nameIndex[hole] = 0;
+    indexedCount--;
+}
+
 
 void Directory::readDirectory() {
+    // Clusters lookup() read while this directory was unloaded are still current; any others are not
+    if (loaded)
+        dropRawClusters();
+    loaded = true;
+    diskSlots.clear();
+    freeSlots.clear();
     if (this->dir_firstCluster != 0)
     {
         DirOrFiles.clear();
         int cluster = this->dir_firstCluster;
         int next = Mini_FAT::getClusterPointer(cluster);
         if (cluster == 5 && next == 0)
+        {
+            dropRawClusters();
             return;
-        vector<char> ls;
-        do
+        }
+
+        vector<Directory_Entry> loaded;
+        if (Dir_BTree::isTree(*rawCluster(0)))
         {
-            vector<char> clusterData = Virtual_Disk::readCluster(cluster);
-            ls.insert(ls.end(), clusterData.begin(), clusterData.end());
-            cluster = next;
-            if (cluster != -1)
-                next = Mini_FAT::getClusterPointer(cluster);
-        } while (cluster != -1);
+            // Already in key order
+            treeFormat = true;
+            loaded = Dir_BTree::readAll(this->dir_firstCluster);
+        }
+        else
+        {
+            treeFormat = false;
+            // Decode each cluster where it lies. Deleted records keep their slot for reuse;
+            // the first unused slot ends the list
+            int slot = 0;
+            bool ended = false;
+            for (size_t n = 0; !ended && rawCluster(n) != nullptr; n++)
+            {
+                const vector<char>& data = rawClusters[n];
+                for (int i = 0; i + 32 <= static_cast<int>(data.size()); i += 32, slot++)
+                {
+                    if (data[i] == 0)
+                    {
+                        ended = true;
+                        break;
+                    }
+                    if (data[i] == DELETED_MARK)
+                    {
+                        freeSlots.push_back(slot);
+                        continue;
+                    }
+                    loaded.push_back(Converter::BytesToDirectory_Entry(&data[i]));
+                    diskSlots.push_back(slot);
+                }
+            }
+        }
+        dropRawClusters();
 
-        DirOrFiles = Converter::BytesToDirectory_Entries(ls);
+        DirOrFiles.swap(loaded);
+        rebuildIndex();
     }
 
 }
 
+void Directory::ensureLoaded()
+{
+    if (!loaded)
+        readDirectory();
+}
+
+void Directory::unload()
+{
+    releaseSlack();
+    // Everything here is rebuilt from disk by readDirectory
+    vector<Directory_Entry>().swap(DirOrFiles);
+    vector<int>().swap(diskSlots);
+    vector<int>().swap(freeSlots);
+    vector<int>().swap(nameIndex);
+    indexedCount = 0;
+    dropRawClusters();
+    loaded = false;
+}
+
+bool Directory::lookup(const Short_Name& key, Directory_Entry& out)
+{
+    if (loaded)
+    {
+        int index = searchDirectory(key);
+        if (index == -1)
+            return false;
+        out = DirOrFiles[index];
+        return true;
+    }
+    if (dir_firstCluster == 0)
+        return false;
+
+    const vector<char>* data = rawCluster(0);
+    if (Dir_BTree::isTree(*data))
+        return Dir_BTree::find(dir_firstCluster, key, out);
+
+    // Flat chain: match the raw name fields cluster by cluster, reading further only while there is
+    // no match, and decode just the record found
+    Name_Scan scan(key);
+    for (size_t n = 0; (data = rawCluster(n)) != nullptr; n++)
+    {
+        bool ended = false;
+        int slot = scan.find(data->data(), static_cast<int>(data->size() / 32), ended);
+        if (slot != -1)
+        {
+            out = Converter::BytesToDirectory_Entry(data->data() + slot * 32);
+            return true;
+        }
+        if (ended)
+            return false;
+    }
+    return false;
+}
+
+void Directory::primeFirstCluster(vector<char> cluster)
+{
+    if (loaded || !rawClusters.empty() || dir_firstCluster <= 0)
+        return;
+    rawClusters.push_back(move(cluster));
+    rawNext = Mini_FAT::getClusterPointer(dir_firstCluster);
+}
+
+// The n-th cluster of the chain as raw bytes, read from disk the first time it is asked for; nullptr past the end
+const vector<char>* Directory::rawCluster(size_t n)
+{
+    while (rawClusters.size() <= n)
+    {
+        int cluster = rawClusters.empty() ? dir_firstCluster : rawNext;
+        if (cluster <= 0)
+            return nullptr;
+        rawClusters.push_back(Virtual_Disk::readCluster(cluster));
+        rawNext = Mini_FAT::getClusterPointer(cluster);
+    }
+    return &rawClusters[n];
+}
+
+void Directory::dropRawClusters()
+{
+    vector<vector<char>>().swap(rawClusters);
+    rawNext = 0;
+}
+
 void Directory::writeDirectory()
 {
+    Chain_Change chain(this);
+    Mini_FAT::Allocation_Hint near(metadataHint());
+    ensureLoaded();
+    if (treeFormat)
+    {
+        // Rebuild the tree under the same root cluster; an emptied directory goes back to the flat format
+        Dir_BTree::freeBelowRoot(dir_firstCluster);
+        if (!DirOrFiles.empty())
+        {
+            sort(DirOrFiles.begin(), DirOrFiles.end(), [](const Directory_Entry& a, const Directory_Entry& b) {
+                return a.key < b.key;
+                });
+            rebuildIndex();
+            Dir_BTree::build(DirOrFiles, dir_firstCluster);
+            Mini_FAT::writeFAT();
+            return;
+        }
+        treeFormat = false;
+    }
+
     Directory_Entry A = this->GetDirectory_Entry();
+    int oldFirstCluster = dir_firstCluster;
     if (!this->DirOrFiles.empty())
     {
         vector<char> dirsOrFilesBytes = Converter::Directory_EntriesToBytes(this->DirOrFiles);
@@ -181,15 +794,30 @@ void Directory::writeDirectory()
             }
         }
     }
+    // The chain now holds every entry in order with no deleted records between them
+    freeSlots.clear();
+    diskSlots.resize(DirOrFiles.size());
+    for (int i = 0; i < static_cast<int>(diskSlots.size()); i++)
+        diskSlots[i] = i;
     if (this->DirOrFiles.empty())
     {
-        if (dir_firstCluster != 0)
-            this->emptymyClusters();
-        if (parent != nullptr)
+        if (parent == nullptr)
+        {
+            // The root keeps its cluster so the next mount finds it; a blank cluster reads back empty
+            if (dir_firstCluster != 0)
+                Virtual_Disk::writeCluster(vector<char>(1024, 0), dir_firstCluster);
+        }
+        else
+        {
+            if (dir_firstCluster != 0)
+                this->emptymyClusters();
             this->dir_firstCluster = 0;
+        }
     }
+    Dir_Cache::moved(this, oldFirstCluster);
     Directory_Entry B = this->GetDirectory_Entry();
-    if (this->parent != nullptr)
+    // The parent only needs its slot rewritten when this directory's record changed (a new first cluster)
+    if (this->parent != nullptr && Converter::Directory_EntryToBytes(A) != Converter::Directory_EntryToBytes(B))
     {
         this->parent->updatecontent(A, B);
     }
@@ -197,46 +825,138 @@ void Directory::writeDirectory()
     Mini_FAT::writeFAT();
 }
 
-string Directory::getFullPath() const
+unsigned Directory::pathEpoch = 1;
+
+void Directory::invalidatePaths()
+{
+    pathEpoch++;
+}
+
+const string& Directory::getFullPath() const
+{
+    if (cachedEpoch != pathEpoch)
+        refreshPaths();
+    return cachedPath;
+}
+
+const string& Directory::getDrive() const
+{
+    if (cachedEpoch != pathEpoch)
+        refreshPaths();
+    return cachedDrive;
+}
+
+// Builds this directory's path and drive from its parent's cached ones, so each level is computed once
+void Directory::refreshPaths() const
 {
+    string name = getName();
+    if (name.length() == 2 && name[1] == ':')
+    {
+        cachedDrive = name.substr(0, 1);
+        transform(cachedDrive.begin(), cachedDrive.end(), cachedDrive.begin(), ::toupper);
+    }
+    else
+    {
+        // Take the drive of the nearest ancestor; "" if there is none
+        cachedDrive = (parent != nullptr) ? parent->getDrive() : "";
+    }
+
     if (parent == nullptr)
     {
         // Root directory using getDrive()
-        string drive = getDrive();
-        if (drive.empty()) {
+        if (cachedDrive.empty()) {
             cout << "Error: Drive letter not found for root directory.\n";
-            return "";
+            cachedPath = "";
+        }
+        else {
+            cachedPath = cachedDrive + ":\\";
         }
-        return drive + ":\\";
     }
     else
     {
-        string parentPath = parent->getFullPath();
+        cachedPath = parent->getFullPath();
+
+        // Ensure the parent path ends with a backslash
+        if (!cachedPath.empty() && cachedPath.back() != '\\')
+            cachedPath += "\\";
+
+        // Validate the name to prevent malformed paths
+        if (name.empty())
+            cout << "Error: Current directory name is empty.\n";  // Parent path as a fallback
+        else
+            cachedPath += name;
+    }
+    cachedEpoch = pathEpoch;
+}
+// Loaded through Dir_Cache, so every caller shares one object per directory. With load = false a
+// directory that is not cached yet comes back unloaded, for path walks that only look up the next name.
+// Counts as an access (Access_Stats); bookkeeping that only needs the object goes to Dir_Cache directly.
+Directory* Directory::getSubDirectory(const Directory_Entry& d, bool load)
+{
+    if (d.dir_attr != 0x10)
+        return nullptr;
+    Access_Stats::record(this, d);
+    return Dir_Cache::get(this, d, load);
+}
 
-        // Ensure parentPath ends with a backslash
-        if (!parentPath.empty() && parentPath.back() != '\\')
-            parentPath += "\\";
+string Directory::getContent(const Directory_Entry& d) const
+{
+    Access_Stats::record(this, d);
+    return Content_Cache::get(d.dir_firstCluster, d.dir_fileSize);
+}
 
-        string currentName = getName();
+// Writes the content to d's chain (reallocating it) and updates d's record; the caller persists this directory
+void Directory::setContent(Directory_Entry& d, const string& content)
+{
+    Dir_Usage delta;
+    delta -= usageOf(d);
+    Mini_FAT::Allocation_Hint near(dataHint());
+    File_Entry file(d, nullptr);
+    file.content = content;
+    file.writeFileContent();
+    d.dir_firstCluster = file.dir_firstCluster;
+    d.dir_fileSize = file.dir_fileSize;
+    Access_Stats::record(this, d);
+    // A record held here changed in place; a new one is counted when it is added
+    delta += usageOf(d);
+    if (ownsEntry(d))
+        applyUsage(delta, delta);
+}
 
-        // Validate currentName to prevent malformed paths
-        if (currentName.empty()) {
-            cout << "Error: Current directory name is empty.\n";
-            return parentPath; // Return parent path as a fallback
-        }
+// Gives d, a record copied out of `from`, its own copy of the file's chain
+void Directory::adoptEntry(Directory_Entry& d, const Directory& from)
+{
+    string content = from.getContent(d);
+    d.dir_firstCluster = 0;
+    d.dir_fileSize = 0;
+    if (!content.empty())
+        setContent(d, content);
+}
 
-        return parentPath + currentName;
+// Frees d's chain before the record is overwritten with another file
+void Directory::discardContent(Directory_Entry& d)
+{
+    if (d.getIsFile() && d.dir_firstCluster != 0)
+    {
+        Dir_Usage delta;
+        delta -= usageOf(d);
+        File_Entry file(d, nullptr);
+        file.emptyMyClusters();
+        d.dir_firstCluster = 0;
+        d.dir_fileSize = 0;
+        delta += usageOf(d);
+        if (ownsEntry(d))
+            applyUsage(delta, delta);
     }
 }
+
 Directory_Entry Directory::findSubDirectory(const string& dirname)
 {
     // Search for a subdirectory with the given name
-    for (const auto& entry : DirOrFiles)
+    int index = searchDirectory(dirname);
+    if (index != -1 && DirOrFiles[index].dir_attr == 0x10)
     {
-        if (entry.dir_attr == 0x10 && entry.getName() == dirname)
-        {
-            return entry;
-        }
+        return DirOrFiles[index];
     }
     // Return a default entry if not found
     Directory_Entry emptyEntry;
@@ -250,14 +970,8 @@ Directory* Directory::getDirectoryByPath(const string& path)
         return this;
     }
 
-    vector<string> pathComponents;
-    string component;
-    stringstream ss (path);
-    while (getline(ss, component, '/'))
-    {
-        if (!component.empty())
-            pathComponents.push_back(component);
-    }
+    // Called from outside any command too, so not from the command arena
+    pmr::vector<string_view> pathComponents = Tokenizer::splitPath(path, pmr::get_default_resource(), "/");
 
     Directory* traversalDir = this;
 
@@ -284,51 +998,144 @@ Directory* Directory::getDirectoryByPath(const string& path)
         else
         {
             // Subdirectory
-            int dirIndex = traversalDir->searchDirectory(dirName);
-            if (dirIndex == -1)
+            Directory_Entry subDirEntry;
+            if (!traversalDir->lookup(Directory_Entry::makeKey(dirName), subDirEntry))
             {
                 // Subdirectory not found
                 return nullptr;
             }
 
-            Directory_Entry subDirEntry = traversalDir->DirOrFiles[dirIndex];
             if (subDirEntry.dir_attr != 0x10)
             {
                 // Not a directory
                 return nullptr;
             }
 
-            // Load the subdirectory
-            traversalDir = new Directory(subDirEntry.getName(), subDirEntry.dir_attr, subDirEntry.dir_firstCluster, traversalDir);
-            traversalDir->readDirectory();
+            // Only the last directory on the path needs its entries
+            traversalDir = traversalDir->getSubDirectory(subDirEntry, false);
         }
     }
 
+    traversalDir->ensureLoaded();
     return traversalDir;
 }
-string Directory::getDrive() const
-{
-    if (getName().length() == 2 && getName()[1] == ':') {
-        string drive = getName().substr(0, 1);
-        transform(drive.begin(), drive.end(), drive.begin(), ::toupper);
-        return drive;
-    }
-    else {
-        // Traverse up to find the root drive
-        const Directory* current = this;
-        while (current->parent != nullptr) {
-            current = current->parent;
-            if (current->getName().length() == 2 && current->getName()[1] == ':') {
-                string drive = current->getName().substr(0, 1);
-                transform(drive.begin(), drive.end(), drive.begin(), ::toupper);
-                return drive;
-            }
-        }
-        return ""; // No drive found
+bool Directory::isEmpty() {
+    // An unloaded directory reads only up to its first record
+    Directory_Entry first;
+    return !Dir_Stream(this).next(first);
+}
+
+Dir_Usage Directory::usageOf(const Directory_Entry& d)
+{
+    Dir_Usage u;
+    if (d.dir_attr == 0x10)
+    {
+        u.dirs = 1;
+        return u;
     }
+    u.files = 1;
+    u.bytes = d.dir_fileSize;
+    if (d.dir_firstCluster != 0)
+        u.clusters = (static_cast<long long>(d.dir_fileSize) + 1 + 1023) / 1024;
+    return u;
+}
+
+const Dir_Usage& Directory::getUsage()
+{
+    if (!usage.ownKnown)
+        computeUsage(false);
+    return usage.own;
 }
 
+const Dir_Usage& Directory::getTreeUsage()
+{
+    if (!usage.treeKnown)
+        computeUsage(true);
+    return usage.tree;
+}
 
-bool Directory::isEmpty() const {
-    return DirOrFiles.empty();
+// One pass over the records; subdirectories are summed through their own (possibly already known) totals
+void Directory::computeUsage(bool withSubtree)
+{
+    Dir_Usage own;
+    Dir_Usage tree;
+    Dir_Stream stream(this);
+    Directory_Entry entry;
+    while (stream.next(entry))
+    {
+        own += usageOf(entry);
+        if (withSubtree && entry.dir_attr == 0x10)
+            tree += Dir_Cache::get(this, entry, false)->getTreeUsage();
+    }
+    own.clusters += chainClusters();
+    usage.own = own;
+    usage.ownKnown = true;
+    if (withSubtree)
+    {
+        tree += own;
+        usage.tree = tree;
+        usage.treeKnown = true;
+    }
+}
+
+// Clusters of this directory's own chain, or nodes of its tree
+int Directory::chainClusters()
+{
+    if (dir_firstCluster == 0 || Mini_FAT::getClusterPointer(dir_firstCluster) == 0)
+        return 0;
+    bool tree = loaded ? treeFormat : Dir_BTree::isTree(Virtual_Disk::readCluster(dir_firstCluster));
+    if (tree)
+        return Dir_BTree::countNodes(dir_firstCluster);
+    int count = 0;
+    for (int cluster = dir_firstCluster; cluster > 0; cluster = Mini_FAT::getClusterPointer(cluster))
+        count++;
+    return count;
+}
+
+// own goes to this directory's own totals; tree to the subtree totals of this directory and every ancestor
+void Directory::applyUsage(const Dir_Usage& own, const Dir_Usage& tree)
+{
+    if (usage.ownKnown)
+        usage.own += own;
+    for (Directory* d = this; d != nullptr; d = d->parent)
+    {
+        if (d->usage.treeKnown)
+            d->usage.tree += tree;
+    }
+}
+
+// Adds (sign 1) or removes (sign -1) one record; subtree is what a subdirectory's record brings below it
+void Directory::countRecord(const Directory_Entry& d, int sign, const Dir_Usage& subtree)
+{
+    Dir_Usage own;
+    Dir_Usage tree;
+    if (sign > 0)
+    {
+        own += usageOf(d);
+        tree += own;
+        tree += subtree;
+    }
+    else
+    {
+        own -= usageOf(d);
+        tree += own;
+        tree -= subtree;
+    }
+    applyUsage(own, tree);
+}
+
+// True if some directory on the path up to the root already has subtree totals to keep current
+bool Directory::treeUsageTracked() const
+{
+    for (const Directory* d = this; d != nullptr; d = d->parent)
+    {
+        if (d->usage.treeKnown)
+            return true;
+    }
+    return false;
+}
+
+bool Directory::ownsEntry(const Directory_Entry& d) const
+{
+    return !DirOrFiles.empty() && &d >= DirOrFiles.data() && &d < DirOrFiles.data() + DirOrFiles.size();
 }
@@ -6,17 +6,84 @@
 #include "Converter.h"
 using namespace std;
 
+// Totals over a directory's records; see Directory::getUsage. A file's clusters follow from its size
+// the way writeFileContent lays it out (size + 1 bytes for the terminator); a directory's own chain
+// or tree nodes count toward that directory.
+struct Dir_Usage
+{
+	long long files = 0;
+	long long dirs = 0;
+	long long bytes = 0;
+	long long clusters = 0;
+
+	Dir_Usage& operator+=(const Dir_Usage& o) { files += o.files; dirs += o.dirs; bytes += o.bytes; clusters += o.clusters; return *this; }
+	Dir_Usage& operator-=(const Dir_Usage& o) { files -= o.files; dirs -= o.dirs; bytes -= o.bytes; clusters -= o.clusters; return *this; }
+};
+
 class Directory : public Directory_Entry {
 	
 	public:
+		static const int ENTRIES_PER_CLUSTER = 1024 / 32;
+		// Past this many entries a directory is stored as a Dir_BTree instead of a flat chain
+		static const size_t TREE_THRESHOLD = 8 * ENTRIES_PER_CLUSTER;
+		// First byte of a deleted record, as in FAT; removeEntry leaves these behind instead of rewriting the chain
+		static constexpr char DELETED_MARK = static_cast<char>(0xE5);
+		// Blank clusters a flat directory reserves past its last one each time its chain has to grow
+		static const int DEFAULT_SLACK_CLUSTERS = 2;
+		// Slack is never reserved once the disk is down to this many free clusters
+		static const int SLACK_MIN_FREE = 64;
+		// Files' data is placed from this many clusters past their directory; the clusters in between
+		// are left to the directory's own chain, its slack and its new subdirectories
+		static const int DATA_ZONE_GAP = TREE_THRESHOLD / ENTRIES_PER_CLUSTER;
+
 		vector< Directory_Entry>DirOrFiles;
 
 		Directory* parent;
 
-        Directory_Entry dir_entry;
+		// Held by cached children and by the shell's current directory; see Dir_Cache
+		int refCount = 0;
+		// Set once the directory has been removed from disk and dropped from Dir_Cache
+		bool removed = false;
+
+		// Stored as a Dir_BTree rooted at dir_firstCluster; DirOrFiles is then kept in key order
+		bool treeFormat = false;
+
+		// Flat format only: the on-disk slot of each entry in DirOrFiles, and slots holding a
+		// deleted record (first byte DELETED_MARK) that addEntry fills before growing the chain
+		vector<int> diskSlots;
+		vector<int> freeSlots;
+
+		// False for a directory opened only to pass through on a path; DirOrFiles is read on first use.
+		// Code that walks DirOrFiles directly calls ensureLoaded() first.
+		bool loaded = true;
+
+		// Clusters of an unloaded directory read so far by lookup(), in chain order, and the chain
+		// cluster after the last of them. readDirectory decodes from these instead of reading again.
+		vector<vector<char>> rawClusters;
+		int rawNext = 0;
+
+		// Open-addressing index from Directory_Entry::key to slot in DirOrFiles (slot + 1, 0 = empty).
+		// Kept in step by addEntry, removeEntry, updatecontent and readDirectory; change DirOrFiles through those.
+		vector<int> nameIndex;
+		size_t indexedCount = 0;
+
+		// Usage of this directory's own records and chain, and of its whole subtree. Each is read from
+		// disk on first use and kept current after that by the mutators below; Dir_Cache keeps it
+		// across eviction so a directory's subtree is walked at most once.
+		struct Usage_State
+		{
+			Dir_Usage own;
+			Dir_Usage tree;
+			bool ownKnown = false;
+			bool treeKnown = false;
+		};
+		Usage_State usage;
 
         Directory(string name, char dir_attr, int dir_firstCluster, Directory* pa);
 
+        // Directory for a record read from the parent; keeps the record's exact 11-byte name
+        Directory(const Directory_Entry& d, Directory* pa);
+
 		Directory_Entry GetDirectory_Entry();
 
 		int getmySizeOnDisk();
@@ -29,6 +96,35 @@ class Directory : public Directory_Entry {
 
 		void readDirectory ();
 
+		void ensureLoaded();
+
+		// Frees the decoded entries and index; the next ensureLoaded() reads them again.
+		// Only between commands, when nothing holds a reference into DirOrFiles. Releases slack first.
+		void unload();
+
+		// Gives back the blank clusters reserved past the last slot in use. Called when the directory
+		// is closed: evicted or unloaded by Dir_Cache, or at shutdown
+		void releaseSlack();
+
+		static void setSlackClusters(int clusters);
+		static int getSlackClusters();
+
+		// Where allocations start looking (see Mini_FAT::Allocation_Hint): for this directory's chain
+		// next to its first cluster (or where its parent puts a new subdirectory, while it has none),
+		// for its files' data DATA_ZONE_GAP clusters further on, and for a new subdirectory per
+		// subdirectoryHint
+		int metadataHint() const;
+		int dataHint() const;
+		int subdirectoryHint() const;
+
+		// Finds one record without loading the directory: an unloaded tree directory reads one node
+		// per level, an unloaded flat one reads clusters only up to the match
+		bool lookup(const Short_Name& key, Directory_Entry& out);
+
+		// Takes the first cluster of the chain read ahead of time (Dir_Prefetch) as if lookup() had
+		// read it; ignored once the directory has read anything itself
+		void primeFirstCluster(vector<char> cluster);
+
 		void addEntry(Directory_Entry d);
 
 		void removeEntry(Directory_Entry d);
@@ -37,15 +133,68 @@ class Directory : public Directory_Entry {
 
 		void updatecontent(Directory_Entry OLD, Directory_Entry New);
 
+		void writeSlot(int slot);
+
 		int searchDirectory(string name);
 
-        string getFullPath() const ;
+		int searchDirectory(const Short_Name& key);
+
+        // Cached per directory; recomputed only after invalidatePaths()
+        const string& getFullPath() const;
 
-        string name;
+        Directory* getSubDirectory(const Directory_Entry& d, bool load = true);
+        string getContent(const Directory_Entry& d) const;
+        void setContent(Directory_Entry& d, const string& content);
+        void adoptEntry(Directory_Entry& d, const Directory& from);
+        void discardContent(Directory_Entry& d);
         Directory_Entry findSubDirectory(const string& dirname);
         Directory* getDirectoryByPath(const string& path);
 
-		string getDrive() const;
-        bool isEmpty() const;
+		const string& getDrive() const;
+
+		// Call when a directory is renamed or moved: every cached path and drive is rebuilt on next use
+		static void invalidatePaths();
+        bool isEmpty();
+
+		const Dir_Usage& getUsage();
+		const Dir_Usage& getTreeUsage();
+
+		// What one record adds to its directory's own usage
+		static Dir_Usage usageOf(const Directory_Entry& d);
+
+	private:
+		class Chain_Change;
+
+		void insertEntry(Directory_Entry d);
+		void eraseEntry(Directory_Entry d);
+		void replaceEntry(Directory_Entry OLD, Directory_Entry New);
+		void countRecord(const Directory_Entry& d, int sign, const Dir_Usage& subtree);
+		void applyUsage(const Dir_Usage& own, const Dir_Usage& tree);
+		bool treeUsageTracked() const;
+		bool ownsEntry(const Directory_Entry& d) const;
+		int chainClusters();
+		void computeUsage(bool withSubtree);
+
+		const vector<char>* rawCluster(size_t n);
+		void dropRawClusters();
+
+		// Valid while cachedEpoch == pathEpoch
+		mutable string cachedPath;
+		mutable string cachedDrive;
+		mutable unsigned cachedEpoch = 0;
+		static unsigned pathEpoch;
+		static int slackClusters;
+
+		void refreshPaths() const;
+
+		int clusterOfSlot(int slot) const;
+		int sortedPosition(const Short_Name& key) const;
+		void convertToTree();
+		void reserveSlack(int last);
+		void rebuildIndex();
+		void indexSlot(int slot);
+		void unindexSlot(int slot);
+		void swapRemove(int index);
+		void compactIfSparse();
 
 	};
@@ -6,37 +6,40 @@
 
 using namespace std; // Using std namespace for convenience
 Directory_Entry::Directory_Entry()
-    : dir_attr(0x00), dir_firstCluster(0), dir_fileSize(0), subDirectory(nullptr)
+    : dir_attr(0x00), dir_firstCluster(0), dir_fileSize(0)
 {
     // Initialize with empty name
     fill(begin(dir_name), end(dir_name), ' ');
     fill(begin(dir_empty), end(dir_empty), ' ');
+    refreshKey();
 }
 
 // Constructor to initialize a Directory_Entry object
-Directory_Entry::Directory_Entry(string name, char attr, int firstCluster)
-    : dir_attr(attr), dir_firstCluster(firstCluster), dir_fileSize(0), subDirectory(nullptr)
+Directory_Entry::Directory_Entry(const string& name, char attr, int firstCluster)
+    : dir_attr(attr), dir_firstCluster(firstCluster), dir_fileSize(0)
 {
     // Assign name based on attribute
     if (attr == 0x10) // Directory
     {
-        assignDir_Name(name);
+        fitName(name.data(), name.size(), dir_name, 11);
     }
     else // File
     {
-        // Split name and extension
+        // Split name and extension in place
         size_t dotPos = name.find_last_of('.');
         if (dotPos != string::npos)
         {
-            string fileName = name.substr(0, dotPos);
-            string extension = name.substr(dotPos + 1);
-            assignFileName(fileName, extension);
+            fitName(name.data(), dotPos, dir_name, 8);
+            fitName(name.data() + dotPos + 1, name.size() - dotPos - 1, dir_name + 8, 3);
         }
         else
         {
-            assignFileName(name, "");
+            fitName(name.data(), name.size(), dir_name, 8);
+            fitName(nullptr, 0, dir_name + 8, 3);
         }
     }
+    escapeLead();
+    refreshKey();
 
     // Initialize dir_empty with blanks
     fill(begin(dir_empty), end(dir_empty), ' ');
@@ -69,83 +72,87 @@ string Directory_Entry::cleanTheName(string name) {
 
     return name; // Valid name
 }
-// Assigns a file name and extension to the dir_name array (8 characters for name, 3 for extension)
-void Directory_Entry::assignFileName( string name,  string extension)
+// Writes s[0..len) into a blank-padded field of `width` bytes, applying the cleanTheName rules
+// (trim spaces, reject invalid characters or more than 11 characters) without building a string
+void Directory_Entry::fitName(const char* s, size_t len, char* out, size_t width)
 {
-    string cleanName = cleanTheName(name);  // Clean the file name
-    string cleanExt = cleanTheName(extension);  // Clean the extension
-
-    // Truncate or pad the name to ensure it's 8 characters long
-    string fname = cleanName.substr(0, 8);
-    fname.resize(8, ' ');  // Pad with spaces if the name is shorter than 8 characters
+    static const char invalidChars[] = R"(/\*?"<>|)";
+
+    size_t first = 0;
+    while (first < len && s[first] == ' ')
+        first++;
+    size_t last = len;
+    while (last > first && s[last - 1] == ' ')
+        last--;
+
+    size_t n = last - first;
+    if (n > 11)
+        n = 0;  // Reject names exceeding length constraints
+    for (size_t i = 0; i < n; i++)
+    {
+        if (strchr(invalidChars, s[first + i]) != nullptr)
+        {
+            n = 0;  // Reject names with an invalid character
+            break;
+        }
+    }
 
-    // Truncate or pad the extension to ensure it's 3 characters long
-    string fext = cleanExt.substr(0, 3);
-    fext.resize(3, ' ');  // Pad with spaces if the extension is shorter than 3 characters
+    if (n > width)
+        n = width;
+    memcpy(out, s + first, n);
+    memset(out + n, ' ', width - n);
+}
 
-    // Copy the name and extension into dir_name (first 8 for name, next 3 for extension)
-    memcpy(dir_name, fname.c_str(), 8);
-    memcpy(dir_name + 8, fext.c_str(), 3);
+// Assigns a file name and extension to the dir_name array (8 characters for name, 3 for extension)
+void Directory_Entry::assignFileName(const string& name, const string& extension)
+{
+    fitName(name.data(), name.size(), dir_name, 8);
+    fitName(extension.data(), extension.size(), dir_name + 8, 3);
+    escapeLead();
+    refreshKey();
 }
 
 // Assigns a directory name to the dir_name array (up to 11 characters)
-void Directory_Entry::assignDir_Name( string name)
+void Directory_Entry::assignDir_Name(const string& name)
 {
-    string cleanName = cleanTheName(name);  // Clean the directory name
-
-    // Truncate or pad the name to ensure it's 11 characters long
-    string dname = cleanName.substr(0, 11);
-    dname.resize(11, ' ');  // Pad with spaces if the name is shorter than 11 characters
-
-    // Copy the directory name into dir_name
-    memcpy(dir_name, dname.c_str(), 11);
+    fitName(name.data(), name.size(), dir_name, 11);
+    escapeLead();
+    refreshKey();
 }
 
-std::string Directory_Entry::getName() const
+// 0xE5 in the first byte marks a deleted record, so a name starting with it is stored with 0x05 as in FAT;
+// Short_Name::fromDirName turns it back
+void Directory_Entry::escapeLead()
 {
-    // 1. Extract base name (first 8 chars)
-    std::string baseName(dir_name, 8);
-
-    // 2. Extract extension (next 3 chars)
-    std::string extension(dir_name + 8, 3);
-
-    // 3. Helper lambda to trim trailing spaces from a string
-    auto trimRight = [](std::string& s) {
-        size_t pos = s.find_last_not_of(' ');
-        if (pos != std::string::npos) {
-            s = s.substr(0, pos + 1);
-        }
-        else {
-            s.clear();
-        }
-        };
-
-    // 4. Trim trailing spaces from baseName and extension
-    trimRight(baseName);
-    trimRight(extension);
+    if (dir_name[0] == static_cast<char>(0xE5))
+        dir_name[0] = 0x05;
+}
 
-    // 5. If we have an extension, join with a dot; otherwise just return baseName
-    if (!extension.empty()) {
-        return baseName + "." + extension;
-    }
-    return baseName;
+// The displayed name as an inline value: base, then "." and the extension if there is one
+Short_Name Directory_Entry::getShortName() const
+{
+    return Short_Name::fromDirName(dir_name);
 }
 
-bool Directory_Entry::getIsFile() const {
-    return isFile;
+std::string Directory_Entry::getName() const
+{
+    return getShortName().str();
 }
 
-void Directory_Entry::setIsFile(bool isFileFlag) {
-    isFile = isFileFlag;
+// Case-folded getShortName(), kept alongside dir_name so lookups never rebuild it
+void Directory_Entry::refreshKey()
+{
+    key = getShortName().folded();
 }
 
-string Directory_Entry::getContent() const {
-    return content;
+// Key for a name typed by the user; names longer than 15 characters can never match an entry
+Short_Name Directory_Entry::makeKey(string_view name)
+{
+    return Short_Name(name.data(), name.size()).folded();
 }
 
-void Directory_Entry::setContent(const string& newContent) {
-    content = newContent;
-    dir_fileSize = static_cast<int>(newContent.size()); // Update file size
+bool Directory_Entry::getIsFile() const {
+    return dir_attr != 0x10;
 }
 
 
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include "Short_Name.h"
 using namespace std;
 
 class Directory;
@@ -9,23 +12,26 @@ class Directory_Entry
 {
 public:
     Directory_Entry();
-    Directory_Entry(string name, char attr, int firstCluster);
-    void assignFileName(string name, string extension);
-    void assignDir_Name(string name);
+    Directory_Entry(const string& name, char attr, int firstCluster);
+    void assignFileName(const string& name, const string& extension);
+    void assignDir_Name(const string& name);
     char dir_name[11];
     char dir_attr;
     char dir_empty[12];
     int dir_firstCluster;
     int dir_fileSize;
-    Directory* subDirectory;
+    // Precomputed from dir_name; call refreshKey() after writing dir_name directly
+    Short_Name key;
+    void refreshKey();
+    static Short_Name makeKey(string_view name);
     static string cleanTheName(string s);
+    Short_Name getShortName() const;
     string getName() const;
     bool getIsFile() const;
-    void setIsFile(bool isFile);
-    string getContent() const;
-    void setContent(const string& content);
-    bool isFile;
-    string content;
     int getSize() const;
 
+private:
+    static void fitName(const char* s, size_t len, char* out, size_t width);
+    void escapeLead();
+
 };
@@ -1,28 +1,18 @@
 #include "File_Entry.h"
+#include "Access_Stats.h"
+#include "Content_Cache.h"
 using namespace std;
 
 File_Entry::File_Entry(string name, char dir_attr, int dir_firstCluster, Directory* pa)
-    : Directory_Entry(name, dir_attr, dir_firstCluster) , content("")
+    : Directory_Entry(name, dir_attr, dir_firstCluster) , content(""), parent(pa)
 {
-    if (pa != nullptr)
-    {
-        parent = pa;
-    }
 }
 
 File_Entry :: File_Entry(Directory_Entry d,Directory * pa)
-    :Directory_Entry (d.dir_name, d.dir_attr, d.dir_firstCluster)
+    :Directory_Entry (d)
 {
-    for (size_t i = 0; i < 12; i++)
-    {
-        dir_empty[i] = d.dir_empty[i];
-    }
-    dir_fileSize = d.dir_fileSize;
     content = "";
-    if (pa != nullptr)
-    {
-       this -> parent = pa;
-    }
+    parent = pa;
 }
 
 int File_Entry::getMySizeOnDisk()
@@ -47,6 +37,7 @@ void File_Entry::emptyMyClusters()
 {
     if (dir_firstCluster != 0)
     {
+        Content_Cache::invalidate(dir_firstCluster);
         int cluster = dir_firstCluster;
         int next = Mini_FAT::getClusterPointer(cluster);
         do
@@ -61,17 +52,15 @@ void File_Entry::emptyMyClusters()
 
 Directory_Entry File_Entry::getDirectory_Entry()
 {
-    Directory_Entry M(dir_name, dir_attr, dir_firstCluster);
-    for (size_t i = 0; i < 12; i++)
-    {
-        M.dir_empty[i] = dir_empty[i];
-    }
-    M.dir_fileSize = dir_fileSize;
+    // The record is plain data, so copy it as is (the name is not NUL-terminated)
+    Directory_Entry M = *this;
     return M;
 }
 
 void File_Entry::writeFileContent()
 {
+    // Without a parent the caller's hint (Directory::setContent sets one) applies
+    Mini_FAT::Allocation_Hint near(parent != nullptr ? parent->dataHint() : Mini_FAT::Allocation_Hint::current());
     Directory_Entry A = this->getDirectory_Entry();
     if (!content.empty())
     {
@@ -108,14 +97,14 @@ void File_Entry::writeFileContent()
     {
         if (dir_firstCluster != 0)
             emptyMyClusters();
-        if (parent != nullptr)
-            dir_firstCluster = 0;
+        dir_firstCluster = 0;
     }
+    dir_fileSize = static_cast<int>(content.size());
+    Content_Cache::put(dir_firstCluster, content);
     Directory_Entry B = getDirectory_Entry();
     if (parent != nullptr)
     {
         parent->updatecontent(A, B);
-        parent->writeDirectory();
     }
 
     Mini_FAT::writeFAT();
@@ -123,23 +112,9 @@ void File_Entry::writeFileContent()
 
 void File_Entry::readFileContent()
 {
-    if (dir_firstCluster != 0)
-    {
-        content = "";
-        int cluster = this->dir_firstCluster;
-        int next = Mini_FAT::getClusterPointer(cluster);
-        vector<char> ls;
-        do
-        {
-            vector<char> clusterData = Virtual_Disk::readCluster(cluster);
-            ls.insert(ls.end(), clusterData.begin(), clusterData.end());
-            cluster = next;
-            if (cluster != -1)
-                next = Mini_FAT::getClusterPointer(cluster);
-        } while (cluster != -1);
-
-        content = Converter::BytesToString(ls);
-    }
+    // Served from the content cache, which reads the chain on first access
+    Access_Stats::record(parent, *this);
+    content = Content_Cache::get(dir_firstCluster, dir_fileSize);
 }
 
 void File_Entry::deleteFile()
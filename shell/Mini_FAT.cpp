@@ -1,10 +1,17 @@
 #include "Mini_FAT.h"
 #include "Converter.h"
-#include "virtual_Disk.h"
+#include "Virtual_Disk.h"
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 using namespace std;
 
 int Mini_FAT::FAT[1024];  // FAT array representing cluster state
+bool Mini_FAT::deferring = false;
+bool Mini_FAT::pendingWrite = false;
+int Mini_FAT::freeCount = 0;
+int Mini_FAT::hintStart = 0;
+int Mini_FAT::groupFree[Mini_FAT::GROUP_COUNT];
 
 // Initializes the FAT array; sets reserved clusters to -1, free clusters to 0
 void Mini_FAT::initialize_FAT() {
@@ -23,6 +30,22 @@ void Mini_FAT::initialize_FAT() {
             FAT[i] = 0;
         }
     }
+    recountFree();
+}
+
+// Rebuilds freeCount after the whole FAT was replaced; setClusterPointer keeps it in step otherwise
+void Mini_FAT::recountFree()
+{
+    freeCount = 0;
+    fill(begin(groupFree), end(groupFree), 0);
+    for (int i = 0; i < 1024; i++)
+    {
+        if (FAT[i] == 0)
+        {
+            freeCount++;
+            groupFree[i / GROUP_CLUSTERS]++;
+        }
+    }
 }
 
 
@@ -45,6 +68,11 @@ vector<char> Mini_FAT::createSuperBlock()
 // Writes the FAT array to the virtual disk by splitting it into clusters
 void Mini_FAT::writeFAT()
 {
+    if (deferring)
+    {
+        pendingWrite = true;
+        return;
+    }
     vector<char> FATBYTES = Converter::intArrayToByteArray(Mini_FAT::FAT, 1024);
     vector<vector<char>> ls = Converter::splitBytes(FATBYTES);
     for (int i = 0; i < ls.size(); i++)
@@ -52,6 +80,21 @@ void Mini_FAT::writeFAT()
         Virtual_Disk::writeCluster(ls[i], i + 1);
     }
 }
+
+void Mini_FAT::beginDeferredWrites()
+{
+    deferring = true;
+}
+
+void Mini_FAT::endDeferredWrites()
+{
+    deferring = false;
+    if (pendingWrite)
+    {
+        pendingWrite = false;
+        writeFAT();
+    }
+}
 // Reads the FAT array from the virtual disk (clusters 1-4) and reconstructs it
 void Mini_FAT::readFAT()
 {
@@ -62,11 +105,13 @@ void Mini_FAT::readFAT()
         ls.insert(ls.end(), b.begin(), b.end());
     }
     Converter::byteArrayToIntArray(Mini_FAT::FAT, ls);
+    recountFree();
 }
 
 // Sets the FAT array with a provided array of integers
 void Mini_FAT::setFAT(const int fat_array[1024]) {
     memcpy(FAT, fat_array, 1024 * sizeof(int));  // Copy input FAT array to the FAT array
+    recountFree();
 }
 
 // Initializes or opens the file system. If the disk file doesn't exist, it creates it
@@ -85,35 +130,71 @@ void Mini_FAT::initialize_Or_Open_FileSystem( string name) {
     }
 }
 
-// Returns the number of free clusters in the FAT array
+// Returns the first free cluster at or after the hinted start, wrapping around
 int Mini_FAT::getAvailableCluster()
 {
-    for (int i = 0; i < 1024; i++)
+    for (int n = 0; n < 1024; n++)
     {
+        int i = (hintStart + n) % 1024;
         if (Mini_FAT::FAT[i] == 0)
             return i;
     }
     return -1;//our disk is full
 }
 
-//Returns the index of the first free cluster in the FAT array
-int Mini_FAT::getAvailableClusters()
+Mini_FAT::Allocation_Hint::Allocation_Hint(int start)
+    : previous(hintStart)
 {
-    int counter = 0;
-    for (int i = 0; i < 1024; i++)
+    hintStart = ((start % 1024) + 1024) % 1024;
+}
+
+Mini_FAT::Allocation_Hint::~Allocation_Hint()
+{
+    hintStart = previous;
+}
+
+int Mini_FAT::Allocation_Hint::current()
+{
+    return hintStart;
+}
+
+int Mini_FAT::getGroupFree(int cluster)
+{
+    return groupFree[(((cluster % 1024) + 1024) % 1024) / GROUP_CLUSTERS];
+}
+
+// Most free clusters wins; ties go to the first group at or after `near`'s
+int Mini_FAT::getEmptiestGroup(int near)
+{
+    int first = (((near % 1024) + 1024) % 1024) / GROUP_CLUSTERS;
+    int best = first;
+    for (int n = 1; n < GROUP_COUNT; n++)
     {
-        if (Mini_FAT::FAT[i] == 0)
-            counter++;
+        int g = (first + n) % GROUP_COUNT;
+        if (groupFree[g] > groupFree[best])
+            best = g;
     }
-    return counter;
+    return best * GROUP_CLUSTERS;
+}
+
+// Returns the number of free clusters, kept as a running count
+int Mini_FAT::getAvailableClusters()
+{
+    return freeCount;
 }
 
 
 // Sets the pointer (next cluster) for a given cluster index in the FAT
 void Mini_FAT::setClusterPointer(int clusterIndex, int status)
 {
-    if (clusterIndex >= 0 && clusterIndex < 1024 && status >= 0 && status < 1024)
+    // -1 marks the end of a chain and must be accepted alongside free (0) and next-cluster values
+    if (clusterIndex >= 0 && clusterIndex < 1024 && status >= -1 && status < 1024)
+    {
+        int change = (status == 0) - (Mini_FAT::FAT[clusterIndex] == 0);
+        freeCount += change;
+        groupFree[clusterIndex / GROUP_CLUSTERS] += change;
         Mini_FAT::FAT[clusterIndex] = status;
+    }
 }
 
 // Retrieves the pointer (next cluster) for a given cluster index in the FAT
@@ -143,13 +224,7 @@ long long Mini_FAT::getTotalClusters() {
 }
 
 long long Mini_FAT::getFreeClusters() {
-    long long count = 0;
-    for (long long i = 0; i < getTotalClusters(); ++i) {
-        if (FAT[i] == 0) { // Assuming 0 indicates a free cluster
-            count++;
-        }
-    }
-    return count;
+    return freeCount;
 }
 
 long long Mini_FAT::getClusterSize() {
@@ -18,6 +18,12 @@ public:
     /** Writes the FAT to the virtual disk by splitting into clusters. */
     static void writeFAT();
 
+    /** Until endDeferredWrites(), writeFAT() only notes that the FAT changed. */
+    static void beginDeferredWrites();
+
+    /** Writes the FAT once if writeFAT() was called since beginDeferredWrites(). */
+    static void endDeferredWrites();
+
     /** Reads the FAT from the virtual disk and reconstructs it. */
     static void readFAT();
 
@@ -30,12 +36,43 @@ public:
     /** Initializes or opens the file system, creating or reading from the virtual disk. */
     static void initialize_Or_Open_FileSystem( string name);
 
-    /** Returns the number of free clusters in the FAT. */
+    /** Returns the number of free clusters in the FAT; O(1), see freeCount. */
     static int getAvailableClusters();
 
-    /** Returns the index of the first available (free) cluster. */
+    /** Returns the index of the first free cluster, searching from the current Allocation_Hint; -1 if the disk is full. */
     static int getAvailableCluster();
 
+    /**
+        While alive, getAvailableCluster() returns the first free cluster at or after `start`, wrapping
+        around, instead of the lowest free one, so related clusters are allocated close together.
+        Hints nest; the enclosing one applies again when a scope ends.
+    */
+    class Allocation_Hint
+    {
+    public:
+        explicit Allocation_Hint(int start);
+        ~Allocation_Hint();
+
+        Allocation_Hint(const Allocation_Hint&) = delete;
+        Allocation_Hint& operator=(const Allocation_Hint&) = delete;
+
+        /** Start of the innermost hint, or 0 when none is active. */
+        static int current();
+
+    private:
+        int previous;
+    };
+
+    /** The disk is split into groups of this many clusters; free clusters are counted per group. */
+    static const int GROUP_CLUSTERS = 64;
+    static const int GROUP_COUNT = 1024 / GROUP_CLUSTERS;
+
+    /** Free clusters in the group holding `cluster`; O(1). */
+    static int getGroupFree(int cluster);
+
+    /** First cluster of the group with the most free clusters, preferring the one holding `near`. */
+    static int getEmptiestGroup(int near);
+
     /** Sets the pointer for a cluster in the FAT (next cluster, EOF, or free). */
     static void setClusterPointer(int clusterIndex, int pointer);
 
@@ -55,4 +92,13 @@ public:
 
 
 private:
+    static bool deferring;
+    static bool pendingWrite;
+
+    /** Free clusters in FAT. Adjusted by setClusterPointer; recounted whenever the whole FAT is replaced. */
+    static int freeCount;
+    static void recountFree();
+
+    static int hintStart;
+    static int groupFree[GROUP_COUNT];
 };
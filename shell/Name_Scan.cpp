@@ -0,0 +1,128 @@
+#include "Name_Scan.h"
+using namespace std;
+
+Name_Scan::Name_Scan(const Short_Name& key)
+    : key(key)
+{
+    const char* k = key.data();
+    size_t len = key.length();
+
+    // Blank extension: the whole name is the base
+    if (len <= 8)
+        addPattern(k, len, nullptr, 0);
+    // Otherwise the name was joined at one of its dots: base of up to 8 bytes, extension of 1 to 3
+    for (size_t dot = 0; dot < len && dot <= 8; dot++)
+    {
+        size_t extLen = len - dot - 1;
+        if (k[dot] == '.' && extLen >= 1 && extLen <= 3)
+            addPattern(k, dot, k + dot + 1, extLen);
+    }
+}
+
+void Name_Scan::addPattern(const char* base, size_t baseLen, const char* ext, size_t extLen)
+{
+    if (patternCount == MAX_PATTERNS)
+        return;
+    char* p = patterns[patternCount++];
+    memset(p, ' ', 11);
+    memset(p + 11, 0, 5);
+    memcpy(p, base, baseLen);
+    if (extLen > 0)
+        memcpy(p + 8, ext, extLen);
+    // Stored names escape a leading 0xE5 as 0x05
+    if (p[0] == static_cast<char>(0xE5))
+        p[0] = 0x05;
+}
+
+// True if the record's 11-byte name, case-folded, equals one of the patterns
+bool Name_Scan::matches(const char* record) const
+{
+#ifdef SHORT_NAME_SSE2
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(record));
+    // Same fold as Short_Name: 'A'..'Z' get 0x20 added
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    v = _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    for (int i = 0; i < patternCount; i++)
+    {
+        __m128i eq = _mm_cmpeq_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(patterns[i])));
+        // Only the 11 name bytes count
+        if ((_mm_movemask_epi8(eq) & 0x7FF) == 0x7FF)
+            return true;
+    }
+    return false;
+#else
+    char folded[11];
+    for (int j = 0; j < 11; j++)
+        folded[j] = (record[j] >= 'A' && record[j] <= 'Z') ? static_cast<char>(record[j] + 0x20) : record[j];
+    for (int i = 0; i < patternCount; i++)
+    {
+        if (memcmp(folded, patterns[i], 11) == 0)
+            return true;
+    }
+    return false;
+#endif
+}
+
+#ifdef SHORT_NAME_SSE2
+static inline __m128i foldName(const char* record)
+{
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(record));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+// Bit j set if record j of the four starting at `records` matches a pattern
+int Name_Scan::matchMask4(const char* records) const
+{
+    __m128i v0 = foldName(records);
+    __m128i v1 = foldName(records + 32);
+    __m128i v2 = foldName(records + 64);
+    __m128i v3 = foldName(records + 96);
+    int hits = 0;
+    for (int i = 0; i < patternCount; i++)
+    {
+        __m128i p = _mm_load_si128(reinterpret_cast<const __m128i*>(patterns[i]));
+        hits |= ((_mm_movemask_epi8(_mm_cmpeq_epi8(v0, p)) & 0x7FF) == 0x7FF) << 0;
+        hits |= ((_mm_movemask_epi8(_mm_cmpeq_epi8(v1, p)) & 0x7FF) == 0x7FF) << 1;
+        hits |= ((_mm_movemask_epi8(_mm_cmpeq_epi8(v2, p)) & 0x7FF) == 0x7FF) << 2;
+        hits |= ((_mm_movemask_epi8(_mm_cmpeq_epi8(v3, p)) & 0x7FF) == 0x7FF) << 3;
+    }
+    return hits;
+}
+#endif
+
+int Name_Scan::find(const char* cluster, int records, bool& ended) const
+{
+    for (int r = 0; r < records; r++)
+    {
+        const char* record = cluster + r * 32;
+        if (record[0] == 0)
+        {
+            ended = true;
+            return -1;
+        }
+#ifdef SHORT_NAME_SSE2
+        // Four records per step: fold each name once and test them all before branching
+        if (r + 4 <= records && cluster[(r + 1) * 32] != 0 && cluster[(r + 2) * 32] != 0 && cluster[(r + 3) * 32] != 0)
+        {
+            int hits = matchMask4(record);
+            if (hits == 0)
+            {
+                r += 3;
+                continue;
+            }
+            for (int j = 0; j < 4; j++)
+            {
+                if ((hits >> j & 1) && Short_Name::fromDirName(record + j * 32).folded() == key)
+                    return r + j;
+            }
+            r += 3;
+            continue;
+        }
+#endif
+        // A deleted record starts with 0xE5, which no pattern does
+        if (matches(record) && Short_Name::fromDirName(record).folded() == key)
+            return r;
+    }
+    return -1;
+}
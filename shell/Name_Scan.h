@@ -0,0 +1,37 @@
+#pragma once
+#include "Short_Name.h"
+using namespace std;
+
+/**
+    Finds a name among the raw 32-byte records of a directory cluster without decoding them.
+
+    The folded key is turned into the few 11-byte dir_name layouts that Short_Name::fromDirName could
+    have produced it from (no extension, or split at one of its dots). Each record's name field is then
+    folded and compared against those in one 16-byte SSE2 compare (a scalar loop without SSE2); a hit is
+    confirmed with fromDirName before it is returned, so the result is exactly that of decoding every
+    record and comparing keys.
+*/
+class Name_Scan
+{
+public:
+    explicit Name_Scan(const Short_Name& key);
+
+    /**
+        Slot of the first live record among `records` 32-byte records at `cluster` whose name matches,
+        or -1. Records from the end marker (first byte 0) on are ignored and `ended` is set when it is seen.
+    */
+    int find(const char* cluster, int records, bool& ended) const;
+
+private:
+    static const int MAX_PATTERNS = 5;
+
+    Short_Name key;
+    alignas(16) char patterns[MAX_PATTERNS][16];
+    int patternCount = 0;
+
+    void addPattern(const char* base, size_t baseLen, const char* ext, size_t extLen);
+    bool matches(const char* record) const;
+#ifdef SHORT_NAME_SSE2
+    int matchMask4(const char* records) const;
+#endif
+};
@@ -1,12 +1,13 @@
 #include "Parser.h"
 using namespace std;
 
-Command Parser::parse(const std::vector<std::string>& tokens) {
-    Command cmd;
+Command Parser::parse(const pmr::vector<string_view>& tokens, pmr::memory_resource* memory) {
+    Command cmd{ string(), Arguments(memory) };
     if (!tokens.empty()) {
         cmd.name = tokens[0];
+        cmd.arguments.reserve(tokens.size() - 1);
         for (size_t i = 1; i < tokens.size(); ++i) {
-            cmd.arguments.push_back(tokens[i]);
+            cmd.arguments.emplace_back(tokens[i]);
         }
     }
     return cmd;
@@ -1,16 +1,22 @@
 #ifndef PARSER_H
 #define PARSER_H
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 using namespace std;
+
+// Argument list of one command; the list and every argument string live in the memory given to Parser::parse
+using Arguments = pmr::vector<pmr::string>;
+
 struct Command {
     string name;                 // The command name (e.g., "rename")
-    vector<string> arguments; // List of arguments (e.g., ["old file.txt", "new file.txt"])
+    Arguments arguments; // List of arguments (e.g., ["old file.txt", "new file.txt"])
 };
 
 class Parser {
 public:
-    static Command parse(const vector<string>& tokens);
+    static Command parse(const pmr::vector<string_view>& tokens, pmr::memory_resource* memory);
 };
 
 #endif // PARSER_H
@@ -0,0 +1,24 @@
+#include "Short_Name.h"
+using namespace std;
+
+Short_Name Short_Name::fromDirName(const char* dirName)
+{
+    Short_Name r;
+    int baseLen = 8;
+    while (baseLen > 0 && dirName[baseLen - 1] == ' ')
+        baseLen--;
+    int extLen = 3;
+    while (extLen > 0 && dirName[8 + extLen - 1] == ' ')
+        extLen--;
+
+    memcpy(r.bytes, dirName, baseLen);
+    if (extLen > 0)
+    {
+        r.bytes[baseLen] = '.';
+        memcpy(r.bytes + baseLen + 1, dirName + 8, extLen);
+    }
+    // A stored 0x05 stands for a leading 0xE5, which on disk would mark the record deleted
+    if (r.bytes[0] == 0x05)
+        r.bytes[0] = static_cast<char>(0xE5);
+    return r;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHORT_NAME_SSE2 1
+#endif
+using namespace std;
+
+/**
+    Name of at most 15 bytes stored inline and zero-padded to 16, so two names compare
+    with a single 128-bit compare. Entry names never exceed 12 (8 + '.' + 3).
+*/
+class Short_Name
+{
+public:
+    static const size_t CAPACITY = 15;
+
+    Short_Name() { memset(bytes, 0, sizeof(bytes)); }
+
+    /** Copies up to CAPACITY bytes; anything longer keeps a non-zero 16th byte and so never equals a real name. */
+    Short_Name(const char* s, size_t len)
+    {
+        memset(bytes, 0, sizeof(bytes));
+        memcpy(bytes, s, len < sizeof(bytes) ? len : sizeof(bytes));
+    }
+
+    explicit Short_Name(const string& s) : Short_Name(s.data(), s.size()) {}
+
+    /** The getName() form of an 11-byte dir_name: trailing blanks trimmed, "." before a non-empty extension, a leading 0x05 read as 0xE5. */
+    static Short_Name fromDirName(const char* dirName);
+
+    size_t length() const { return strnlen(bytes, sizeof(bytes)); }
+    bool empty() const { return bytes[0] == 0; }
+    const char* data() const { return bytes; }
+    string str() const { return string(bytes, length()); }
+
+    /** ASCII lower-cased copy. */
+    Short_Name folded() const
+    {
+        Short_Name r;
+#ifdef SHORT_NAME_SSE2
+        _mm_store_si128(reinterpret_cast<__m128i*>(r.bytes), fold(load()));
+#else
+        for (size_t i = 0; i < sizeof(bytes); i++)
+            r.bytes[i] = (bytes[i] >= 'A' && bytes[i] <= 'Z') ? static_cast<char>(bytes[i] + 0x20) : bytes[i];
+#endif
+        return r;
+    }
+
+    bool operator==(const Short_Name& other) const
+    {
+#ifdef SHORT_NAME_SSE2
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(load(), other.load())) == 0xFFFF;
+#else
+        uint64_t a[2], b[2];
+        memcpy(a, bytes, 16);
+        memcpy(b, other.bytes, 16);
+        return ((a[0] ^ b[0]) | (a[1] ^ b[1])) == 0;
+#endif
+    }
+
+    bool operator!=(const Short_Name& other) const { return !(*this == other); }
+
+    /** Case-insensitive equality: folds both sides in registers and does one compare. */
+    bool equalsIgnoreCase(const Short_Name& other) const
+    {
+#ifdef SHORT_NAME_SSE2
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(fold(load()), fold(other.load()))) == 0xFFFF;
+#else
+        return folded() == other.folded();
+#endif
+    }
+
+    /** 64-bit mix of both halves; equal names hash equal, so fold first for case-insensitive tables. */
+    uint64_t hash() const
+    {
+        uint64_t w[2];
+        memcpy(w, bytes, 16);
+        uint64_t h = w[0] ^ (w[1] * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return h;
+    }
+
+    /** Same order as comparing the std::string forms (bytes compare unsigned, padding sorts first). */
+    bool operator<(const Short_Name& other) const { return memcmp(bytes, other.bytes, sizeof(bytes)) < 0; }
+
+private:
+    alignas(16) char bytes[16];
+
+#ifdef SHORT_NAME_SSE2
+    __m128i load() const { return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes)); }
+
+    static __m128i fold(__m128i v)
+    {
+        // Bytes in 'A'..'Z' get 0x20 added; signed compares leave bytes >= 0x80 untouched
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+            _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
+#endif
+};
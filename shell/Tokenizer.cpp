@@ -1,29 +1,50 @@
 #include "Tokenizer.h"
-#include <sstream>
 #include <cctype>
 using namespace std;
-vector<string> Tokenizer::tokenize(const string& input)
+pmr::vector<string_view> Tokenizer::tokenize(string_view input, pmr::memory_resource* memory)
 {
-    vector<string> tokens;
-    istringstream stream(input);
-    string token;
-    bool inQuotes = false;
-    string currentToken;
+    pmr::vector<string_view> tokens(memory);
+    size_t i = 0;
 
-    while (stream >> ws) { // Skip any leading whitespace
-        char c = stream.peek();
-        if (c == '\"') {
-            // Handle quoted string
-            stream.get(); // Consume the opening quote
-            getline(stream, token, '\"'); // Read until closing quote
-            tokens.push_back(token);
+    while (true) {
+        // Skip any leading whitespace
+        while (i < input.size() && isspace(static_cast<unsigned char>(input[i])))
+            i++;
+        if (i == input.size())
+            break;
+
+        size_t start = i;
+        if (input[i] == '\"') {
+            // Handle quoted string: everything up to the closing quote, or to the end without one
+            start = ++i;
+            while (i < input.size() && input[i] != '\"')
+                i++;
+            tokens.push_back(input.substr(start, i - start));
+            if (i < input.size())
+                i++; // Consume the closing quote
         }
         else {
             // Read the next word
-            stream >> token;
-            tokens.push_back(token);
+            while (i < input.size() && !isspace(static_cast<unsigned char>(input[i])))
+                i++;
+            tokens.push_back(input.substr(start, i - start));
         }
     }
 
     return tokens;
 }
+
+pmr::vector<string_view> Tokenizer::splitPath(string_view path, pmr::memory_resource* memory, string_view separators)
+{
+    pmr::vector<string_view> components(memory);
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find_first_of(separators, start);
+        if (end == string_view::npos)
+            end = path.size();
+        if (end > start)
+            components.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return components;
+}
@@ -1,11 +1,16 @@
 #ifndef TOKENIZER_H
 #define TOKENIZER_H
+#include <memory_resource>
+#include <string_view>
 #include <vector>
-#include <string>
 using namespace std;
 
 class Tokenizer {
 public:
-    static vector<string> tokenize(const string& input);
+    // Tokens are views into input, which must outlive them; the list itself comes from memory
+    static pmr::vector<string_view> tokenize(string_view input, pmr::memory_resource* memory);
+
+    // Non-empty components of path between any of the separator characters, as views into path
+    static pmr::vector<string_view> splitPath(string_view path, pmr::memory_resource* memory, string_view separators = "\\");
 };
 #endif // TOKENIZER_H
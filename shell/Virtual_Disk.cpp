@@ -1,11 +1,17 @@
 #include "Virtual_Disk.h"
+#include <algorithm>
 using namespace std;
 
 // Initialize the static file stream object for the virtual disk
 fstream Virtual_Disk::Disk;
+map<int, vector<char>> Virtual_Disk::buffered;
+bool Virtual_Disk::buffering = false;
+string Virtual_Disk::diskPath;
+thread_local ifstream* Virtual_Disk::threadDisk = nullptr;
 
 // Functions
 void Virtual_Disk::createOrOpenDisk(const string& path) {
+    diskPath = path;
     Disk.open(path, ios::in | ios::out | ios::binary);
 
     if (!Disk.is_open()) {
@@ -20,6 +26,16 @@ void Virtual_Disk::createOrOpenDisk(const string& path) {
 
 void Virtual_Disk::writeCluster(const vector<char>& cluster, int clusterIndex)
 {
+    if (buffering)
+    {
+        buffered[clusterIndex] = cluster;
+        buffered[clusterIndex].resize(1024, 0);
+        return;
+    }
+
+    // Clear eof/fail left by an earlier read past the end, or every later write is dropped
+    Disk.clear();
+
     // Move the write pointer to the position of the specified cluster index
     Disk.seekp(clusterIndex * 1024, ios::beg);
    
@@ -36,13 +52,47 @@ void Virtual_Disk::writeCluster(const vector<char>& cluster, int clusterIndex)
     
 }
 
+void Virtual_Disk::writeClusterBytes(const vector<char>& bytes, int clusterIndex, int offset)
+{
+    if (buffering)
+    {
+        // Patch the buffered copy, reading the cluster in first if this is its first write
+        auto it = buffered.find(clusterIndex);
+        if (it == buffered.end())
+            it = buffered.emplace(clusterIndex, readCluster(clusterIndex)).first;
+        copy(bytes.begin(), bytes.end(), it->second.begin() + offset);
+        return;
+    }
+    Disk.clear();
+    Disk.seekp(clusterIndex * 1024 + offset, ios::beg);
+    Disk.write(bytes.data(), bytes.size());
+    Disk.flush();
+}
+
 vector<char> Virtual_Disk::readCluster(int clusterIndex)
 {
+    if (buffering)
+    {
+        auto it = buffered.find(clusterIndex);
+        if (it != buffered.end())
+            return it->second;
+    }
+
+    if (threadDisk != nullptr)
+    {
+        vector<char> bytes(1024);
+        threadDisk->clear();
+        threadDisk->seekg(clusterIndex * 1024, ios::beg);
+        threadDisk->read(bytes.data(), 1024);
+        return bytes;
+    }
+
     /*
     Moves the file read pointer to the beginning of the specified cluster.
     The cluster is 1024 bytes, and we move the pointer by multiplying the
     cluster index by 1024 (the size of one cluster).
     */
+    Disk.clear();
     Disk.seekg(clusterIndex * 1024, ios::beg);
     
 
@@ -78,4 +128,33 @@ void Virtual_Disk::closeDisk()
     if (Disk.is_open()) {
         Disk.close();
     }
-}
\ No newline at end of file
+}
+
+Virtual_Disk::Thread_Reader::Thread_Reader()
+    : file(diskPath, ios::in | ios::binary)
+{
+    threadDisk = &file;
+}
+
+Virtual_Disk::Thread_Reader::~Thread_Reader()
+{
+    threadDisk = nullptr;
+}
+
+void Virtual_Disk::beginBuffering()
+{
+    buffering = true;
+}
+
+void Virtual_Disk::endBuffering()
+{
+    buffering = false;
+    for (const auto& cluster : buffered)
+    {
+        Disk.clear();
+        Disk.seekp(cluster.first * 1024, ios::beg);
+        Disk.write(cluster.second.data(), 1024);
+    }
+    buffered.clear();
+    Disk.flush();
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 using namespace std;
@@ -15,6 +16,9 @@ public:
     /** Writes a 1024-byte cluster to the virtual disk at the specified index. */
     static void writeCluster(const vector<char>& cluster, int clusterIndex);
 
+    /** Overwrites bytes.size() bytes of a cluster starting at offset, leaving the rest of the cluster as it is. */
+    static void writeClusterBytes(const vector<char>& bytes, int clusterIndex, int offset);
+
     /** Reads a 1024-byte cluster from the virtual disk at the specified index. */
     static vector<char> readCluster(int clusterIndex);
 
@@ -23,9 +27,38 @@ public:
 
     static void closeDisk();
 
-    
+    /** From here until endBuffering(), writes are kept in memory (reads see them) instead of going to the file. */
+    static void beginBuffering();
+
+    /** Writes every cluster touched since beginBuffering() once, in cluster order, and flushes the file once. */
+    static void endBuffering();
+
+    /**
+        While alive, readCluster on the constructing thread goes through that thread's own read-only
+        handle on the disk file, so several threads can read at once. Only while nothing writes.
+    */
+    class Thread_Reader
+    {
+    public:
+        Thread_Reader();
+        ~Thread_Reader();
+
+        Thread_Reader(const Thread_Reader&) = delete;
+        Thread_Reader& operator=(const Thread_Reader&) = delete;
+
+    private:
+        ifstream file;
+    };
 
 private:
     /** File stream for the virtual disk, opened in read/write binary mode. */
     static fstream Disk;
+
+    /** Clusters written while buffering, by index. */
+    static map<int, vector<char>> buffered;
+    static bool buffering;
+
+    static string diskPath;
+    /** The calling thread's Thread_Reader handle, if it has one. */
+    static thread_local ifstream* threadDisk;
 };
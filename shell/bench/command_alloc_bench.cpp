@@ -0,0 +1,187 @@
+#include "CommandProcessor.h"
+#include "Dir_Cache.h"
+#include "Directory.h"
+#include "Mini_FAT.h"
+#include "Virtual_Disk.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+    Heap allocations per shell command.
+
+    Usage: command_alloc_bench [repeats]
+
+    Builds a small tree on a scratch disk image (command_alloc_bench.bin in the
+    working directory), then runs each command `repeats` times (default 200) with
+    its output discarded and reports the average number of operator new calls and
+    the time per command. Setup commands are not counted.
+*/
+
+static size_t allocations = 0;
+
+// Every replaceable form is defined so each allocation is counted once and freed by its matching
+// function; the array, sized and nothrow forms all go through these two
+static void* countedAlloc(size_t size, size_t alignment)
+{
+    allocations++;
+    size = size == 0 ? 1 : size;
+    void* p = nullptr;
+    if (alignment <= alignof(max_align_t))
+        p = malloc(size);
+    else if (posix_memalign(&p, alignment, size) != 0)
+        p = nullptr;
+    return p;
+}
+
+// Kept out of line: once free() is inlined into a caller, GCC pairs it with the operator new it
+// sees there and reports a mismatch (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void countedFree(void* p) noexcept
+{
+    free(p);
+}
+
+void* operator new(size_t size)
+{
+    if (void* p = countedAlloc(size, alignof(max_align_t)))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, align_val_t alignment)
+{
+    if (void* p = countedAlloc(size, static_cast<size_t>(alignment)))
+        return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size, align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size, alignof(max_align_t));
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept
+{
+    return countedAlloc(size, alignof(max_align_t));
+}
+
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { countedFree(p); }
+
+// Swallows the shell's output without allocating
+class Null_Buffer : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+int main(int argc, char* argv[])
+{
+    int repeats = (argc > 1) ? atoi(argv[1]) : 200;
+    const string diskPath = "command_alloc_bench.bin";
+    remove(diskPath.c_str());
+
+    Mini_FAT::initialize_Or_Open_FileSystem(diskPath);
+    Virtual_Disk::writeCluster(vector<char>(1024, 0), 5);
+    Mini_FAT::setClusterPointer(5, -1);
+    Mini_FAT::writeFAT();
+    Directory* root = new Directory("C:", 0x10, 5, nullptr);
+    root->readDirectory();
+    Directory* current = root;
+    CommandProcessor processor(&current);
+    bool running = true;
+
+    Null_Buffer null;
+    streambuf* console = cout.rdbuf(&null);
+    auto run = [&](const string& command)
+    {
+        processor.processCommand(command, running);
+        Dir_Cache::trim(current);
+    };
+
+    // A few levels with enough entries that listings and lookups do real work
+    run("md docs");
+    run("md docs\\work");
+    run("md docs\\work\\deep");
+    for (int i = 0; i < 60; i++)
+        run("echo docs\\work\\file" + to_string(i) + ".txt");
+    run("cd docs\\work");
+
+    const vector<string> commands = {
+        "pwd",
+        "cd deep",
+        "cd ..",
+        "cd C:\\docs\\work\\deep",
+        "cd C:\\docs\\work",
+        "dir",
+        "dir C:\\docs\\work",
+        "type file7.txt",
+        "rename file7.txt renamed.txt",
+        "rename renamed.txt file7.txt",
+        "help dir",
+    };
+
+    cout.rdbuf(console);
+    cout << left << setw(34) << "command" << right << setw(14) << "allocs/cmd" << setw(12) << "us/cmd" << "\n";
+    for (const string& command : commands)
+    {
+        cout.rdbuf(&null);
+        run(command);  // warm-up
+        size_t before = allocations;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < repeats; i++)
+            run(command);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        size_t counted = allocations - before;
+        cout.rdbuf(console);
+        cout << left << setw(34) << command << right << setw(14) << fixed << setprecision(1)
+            << static_cast<double>(counted) / repeats << setw(12) << setprecision(2) << seconds * 1e6 / repeats << "\n";
+    }
+
+    Mini_FAT::CloseTheSystem();
+    Dir_Cache::release(current);
+    Dir_Cache::clear();
+    delete root;
+    remove(diskPath.c_str());
+    return 0;
+}
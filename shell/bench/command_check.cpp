@@ -0,0 +1,365 @@
+#include "CommandProcessor.h"
+#include "Content_Cache.h"
+#include "Dir_BTree.h"
+#include "Dir_Cache.h"
+#include "Directory.h"
+#include "Mini_FAT.h"
+#include "Virtual_Disk.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+    End-to-end checks of shell commands against the FAT.
+
+    Usage: command_check
+
+    Runs commands through CommandProcessor on a scratch disk image
+    (command_check.bin in the working directory) and checks the disk
+    bookkeeping they leave behind. Exits non-zero on any failure.
+*/
+
+static int failures = 0;
+
+static void check(bool ok, const string& what)
+{
+    if (!ok)
+    {
+        failures++;
+        // cout is captured while commands run
+        if (failures <= 20)
+            cerr << "FAIL: " << what << "\n";
+    }
+}
+
+// Free clusters counted from the FAT itself, independently of Mini_FAT's running count
+static long long countFree()
+{
+    long long free = 0;
+    for (int i = 0; i < 1024; i++)
+    {
+        if (Mini_FAT::FAT[i] == 0)
+            free++;
+    }
+    return free;
+}
+
+int main()
+{
+    const string diskPath = "command_check.bin";
+    remove(diskPath.c_str());
+    Mini_FAT::initialize_Or_Open_FileSystem(diskPath);
+    Virtual_Disk::writeCluster(vector<char>(1024, 0), 5);
+    Mini_FAT::setClusterPointer(5, -1);
+    Mini_FAT::writeFAT();
+    Directory* root = new Directory("C:", 0x10, 5, nullptr);
+    root->readDirectory();
+    Directory* current = root;
+    CommandProcessor processor(&current);
+    bool running = true;
+
+    ostringstream output;
+    streambuf* console = cout.rdbuf(output.rdbuf());
+    // `answers` feeds the confirmation prompts (rd asks once per directory)
+    auto run = [&](const string& command, const string& answers = "")
+    {
+        istringstream input(answers);
+        streambuf* keyboard = cin.rdbuf(input.rdbuf());
+        processor.processCommand(command, running);
+        cin.rdbuf(keyboard);
+        Dir_Cache::trim(current);
+    };
+
+    // Closes the disk the way the shell does at exit and opens it again, with nothing left cached
+    auto remount = [&]()
+    {
+        Dir_Cache::releaseSlack();
+        root->releaseSlack();
+        Mini_FAT::CloseTheSystem();
+        Dir_Cache::release(current);
+        Dir_Cache::clear();
+        delete root;
+        size_t contentBudget = Content_Cache::getBudget();
+        Content_Cache::setBudget(0);
+        Content_Cache::setBudget(contentBudget);
+        Mini_FAT::initialize_Or_Open_FileSystem(diskPath);
+        root = new Directory("C:", 0x10, 5, nullptr);
+        root->readDirectory();
+        current = root;
+    };
+    // Length of a cluster chain as the FAT records it
+    auto chainLength = [](int cluster)
+    {
+        int length = 0;
+        while (cluster > 0)
+        {
+            length++;
+            cluster = Mini_FAT::FAT[cluster];
+        }
+        return length;
+    };
+    auto subDirectory = [&](const string& name) -> Directory*
+    {
+        int index = root->searchDirectory(name);
+        return index == -1 ? nullptr : root->getSubDirectory(root->DirOrFiles[index]);
+    };
+    auto contentOf = [&](const string& dirName, const string& fileName)
+    {
+        Directory* dir = subDirectory(dirName);
+        int index = dir->searchDirectory(fileName);
+        return index == -1 ? string("<missing>") : dir->getContent(dir->DirOrFiles[index]);
+    };
+
+    // md reserves a first cluster for the new directory; rd has to give it back
+    {
+        long long before = Mini_FAT::getFreeClusters();
+        long long rootClusters = root->getTreeUsage().clusters;
+        for (int i = 0; i < 3; i++)
+        {
+            run("md empty");
+            run("rd empty", "y\n");
+        }
+        run("md outer");
+        run("md outer\\inner");
+        run("rd outer\\inner", "y\n");
+        run("rd outer", "y\n");
+        // A rejected name must not cost a cluster either
+        for (int i = 0; i < 3; i++)
+            run("md abcdefghijklmnop");
+        run("md bad?name");
+        run("md bad<name");
+        check(root->searchDirectory("empty") == -1 && root->searchDirectory("outer") == -1, "md/rd: directories still listed");
+        check(Mini_FAT::getFreeClusters() == before, "md/rd: free cluster count changed");
+        check(countFree() == before, "md/rd: clusters left allocated in the FAT");
+        check(root->getTreeUsage().clusters == rootClusters, "md/rd: usage totals changed");
+    }
+
+    // Copying a file onto itself, directly or through its directory, must leave its content alone
+    {
+        run("md same");
+        run("echo same\\a.txt");
+        run("write same\\a.txt", "first file\nEND\n");
+        run("echo same\\b.txt");
+        run("write same\\b.txt", "second file\nEND\n");
+        long long before = Mini_FAT::getFreeClusters();
+        run("copy same\\a.txt same", "y\n");
+        run("copy same same", "y\ny\n");
+        check(contentOf("same", "a.txt") == "first file\n", "copy: file copied onto itself lost its content");
+        check(contentOf("same", "b.txt") == "second file\n", "copy: directory copied onto itself lost its content");
+        check(Mini_FAT::getFreeClusters() == before, "copy: self-copy changed the free cluster count");
+        remount();
+        check(contentOf("same", "a.txt") == "first file\n" && contentOf("same", "b.txt") == "second file\n",
+            "copy: self-copy lost content on disk");
+        check(countFree() == before, "copy: self-copy changed the FAT");
+    }
+
+    // A directory grown into a multi-level B-tree and shrunk again in random order: the records,
+    // the FAT and the running free count must agree after a remount, and emptying it goes back to flat
+    {
+        const int total = 600, kept = 20;
+        long long before = countFree();
+        run("md big");
+        vector<string> names;
+        for (int i = 0; i < total; i++)
+        {
+            string name = "f" + to_string(1000 + i) + ".txt";
+            names.push_back(name);
+            run("echo big\\" + name);
+        }
+        Directory* big = subDirectory("big");
+        check(big && big->treeFormat, "btree: directory did not switch to the tree format");
+        if (big && big->treeFormat)
+        {
+            // Root split: the root's first child is itself an inner node
+            vector<char> rootNode = Virtual_Disk::readCluster(big->dir_firstCluster);
+            int firstChild = 0;
+            memcpy(&firstChild, rootNode.data() + 16, 4);
+            check(rootNode[4] == 0 && Virtual_Disk::readCluster(firstChild)[4] == 0, "btree: tree never grew a third level");
+        }
+
+        mt19937 rng(35);
+        shuffle(names.begin(), names.end(), rng);
+        for (int i = 0; i < total - kept; i += 5)
+        {
+            string command = "del";
+            for (int j = i; j < i + 5 && j < total - kept; j++)
+                command += " C:\\big\\" + names[j];
+            run(command, "y\ny\ny\ny\ny\n");
+        }
+        check(Mini_FAT::getFreeClusters() == countFree(), "btree: free cluster count out of step with the FAT");
+
+        remount();
+        big = subDirectory("big");
+        set<string> expected(names.end() - kept, names.end());
+        set<string> listed;
+        if (big)
+        {
+            for (const auto& entry : big->DirOrFiles)
+                listed.insert(entry.getName());
+        }
+        check(listed == expected, "btree: listing after deletes and remount");
+        check(big && big->treeFormat && countFree() == before - Dir_BTree::countNodes(big->dir_firstCluster),
+            "btree: clusters left allocated in the FAT");
+
+        for (int i = total - kept; i < total; i++)
+            run("del C:\\big\\" + names[i], "y\n");
+        big = subDirectory("big");
+        check(big && !big->treeFormat && big->DirOrFiles.empty(), "btree: emptied directory still in the tree format");
+        check(big && (big->dir_firstCluster == 0 || !Dir_BTree::isTree(Virtual_Disk::readCluster(big->dir_firstCluster))),
+            "btree: emptied directory still holds a tree node");
+        check(Mini_FAT::getFreeClusters() == countFree(), "btree: free cluster count after emptying");
+        run("rd big", "y\n");
+        remount();
+        check(countFree() == before, "btree: clusters left allocated after rd");
+    }
+
+    // A flat directory marks deleted records in place and fills those slots before growing its chain;
+    // once deleted records outnumber the live ones the chain is rewritten without them
+    {
+        const int total = 60;
+        long long before = countFree();
+        run("md flat");
+        vector<string> names;
+        for (int i = 0; i < total; i++)
+        {
+            names.push_back("g" + to_string(100 + i) + ".txt");
+            run("echo flat\\" + names.back());
+        }
+        for (int i = 0; i < 3; i++)
+            run("write flat\\" + names[i], string(1500, 'x') + "\nEND\n");
+
+        string command = "del";
+        for (int i = 0; i < 10; i++)
+            command += " C:\\flat\\" + names[i];
+        run(command, string(20, 'y'));
+        Directory* flat = subDirectory("flat");
+        check(flat && flat->freeSlots.size() == 10, "tombstones: deleted records not kept as free slots");
+        check(Mini_FAT::getFreeClusters() == countFree(), "tombstones: free cluster count after del");
+
+        remount();
+        flat = subDirectory("flat");
+        check(flat && flat->freeSlots.size() == 10, "tombstones: deleted records not found after remount");
+        int chain = flat ? chainLength(flat->dir_firstCluster) : 0;
+        for (int i = 0; i < 10; i++)
+        {
+            names[i] = "h" + to_string(100 + i) + ".txt";
+            run("echo flat\\" + names[i]);
+        }
+        flat = subDirectory("flat");
+        check(flat && flat->freeSlots.empty() && chainLength(flat->dir_firstCluster) == chain,
+            "tombstones: new records did not reuse the deleted slots");
+
+        remount();
+        flat = subDirectory("flat");
+        set<string> listed;
+        if (flat)
+        {
+            for (const auto& entry : flat->DirOrFiles)
+                listed.insert(entry.getName());
+        }
+        check(listed == set<string>(names.begin(), names.end()), "tombstones: listing after reuse and remount");
+        check(flat && countFree() == before - chainLength(flat->dir_firstCluster), "tombstones: clusters left allocated in the FAT");
+
+        command = "del";
+        for (int i = 0; i < 40; i++)
+            command += " C:\\flat\\" + names[i];
+        run(command, string(80, 'y'));
+        flat = subDirectory("flat");
+        // The 32nd deleted record outnumbers the 28 live ones and triggers the rewrite; the last 8 are marked again
+        check(flat && flat->freeSlots.size() == 8 && chainLength(flat->dir_firstCluster) == 1, "tombstones: sparse chain not compacted");
+        check(Mini_FAT::getFreeClusters() == countFree(), "tombstones: free cluster count after compaction");
+
+        remount();
+        flat = subDirectory("flat");
+        check(flat && flat->DirOrFiles.size() == total - 40 && countFree() == before - 1, "tombstones: compacted chain on disk");
+        command = "del";
+        for (int i = 40; i < total; i++)
+            command += " C:\\flat\\" + names[i];
+        run(command, string(40, 'y'));
+        run("rd flat", "y\n");
+        check(countFree() == before && Mini_FAT::getFreeClusters() == before, "tombstones: clusters left allocated after rd");
+    }
+
+    // A flat directory that outgrows its chain reserves slack clusters; they go back to the FAT when
+    // the directory is evicted from the cache and when the disk is closed, and rd frees them too
+    {
+        long long before = countFree();
+        run("md grow");
+        for (int i = 0; i < 33; i++)
+            run("echo grow\\s" + to_string(100 + i) + ".txt");
+        Directory* grow = subDirectory("grow");
+        int first = grow ? grow->dir_firstCluster : 0;
+        check(chainLength(first) == 2 + Directory::DEFAULT_SLACK_CLUSTERS, "slack: growing chain reserved no slack");
+        check(Mini_FAT::getFreeClusters() == countFree(), "slack: free cluster count after reserving");
+
+        size_t budget = Dir_Cache::getBudget();
+        Dir_Cache::setBudget(0);
+        Dir_Cache::trim(current);
+        Dir_Cache::setBudget(budget);
+        check(Dir_Cache::findByCluster(first) == nullptr, "slack: directory not evicted");
+        check(chainLength(first) == 2 && countFree() == before - 2, "slack: eviction left slack allocated");
+        check(Mini_FAT::getFreeClusters() == countFree(), "slack: free cluster count after eviction");
+
+        for (int i = 33; i < 65; i++)
+            run("echo grow\\s" + to_string(100 + i) + ".txt");
+        check(chainLength(first) == 3 + Directory::DEFAULT_SLACK_CLUSTERS, "slack: second growth reserved no slack");
+        remount();
+        check(chainLength(first) == 3 && countFree() == before - 3, "slack: closing the disk left slack allocated");
+
+        for (int i = 65; i < 97; i++)
+            run("echo grow\\s" + to_string(100 + i) + ".txt");
+        check(chainLength(first) == 4 + Directory::DEFAULT_SLACK_CLUSTERS, "slack: growth after remount reserved no slack");
+        string command = "del";
+        for (int i = 0; i < 97; i++)
+            command += " C:\\grow\\s" + to_string(100 + i) + ".txt";
+        run(command, string(100, 'y'));
+        run("rd grow", "y\n");
+        check(countFree() == before && Mini_FAT::getFreeClusters() == before, "slack: clusters left allocated after rd");
+    }
+
+    // du walks the whole tree once; that must not show up in what `hot` reports
+    {
+        auto capture = [&](const string& command)
+        {
+            output.str("");
+            run(command);
+            return output.str();
+        };
+        run("md proj");
+        run("md proj\\src");
+        run("md proj\\src\\deep");
+        run("md other");
+        for (int i = 0; i < 4; i++)
+            run("md other\\d" + to_string(i));
+        run("echo proj\\src\\main.txt");
+        for (int i = 0; i < 5; i++)
+        {
+            run("cd proj\\src");
+            run("cd C:\\");
+        }
+        string before = capture("hot 32");
+        check(before.find("proj") != string::npos, "hot: path walks not counted");
+        run("du");
+        run("du proj");
+        run("du other");
+        check(capture("hot 32") == before, "hot: du changed the access counts");
+    }
+
+    cout.rdbuf(console);
+    Dir_Cache::releaseSlack();
+    root->releaseSlack();
+    Mini_FAT::CloseTheSystem();
+    Dir_Cache::release(current);
+    Dir_Cache::clear();
+    delete root;
+    remove(diskPath.c_str());
+
+    cout << (failures == 0 ? "OK" : "FAILED") << " (" << failures << " failures)\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include "Converter.h"
+#include "Directory_Entry.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+    Throughput benchmark for Converter.
+
+    Usage: converter_bench [scale]
+
+    Each case converts a realistic payload back and forth: the whole 1024-entry
+    FAT, directories of one cluster up to a full disk's worth of records, and
+    file bodies from a single cluster up to the largest file the disk holds.
+    `scale` multiplies the repetition count (default 1).
+*/
+
+// Accumulated and printed at the end so the optimizer keeps every conversion
+static size_t sink = 0;
+
+static void report(const string& name, size_t bytesPerRep, int reps, chrono::steady_clock::duration elapsed)
+{
+    double seconds = chrono::duration<double>(elapsed).count();
+    double mbPerSec = (static_cast<double>(bytesPerRep) * reps) / (1024.0 * 1024.0) / seconds;
+    double usPerRep = seconds * 1e6 / reps;
+    cout << left << setw(34) << name
+        << right << setw(10) << reps << " reps"
+        << setw(12) << fixed << setprecision(2) << usPerRep << " us/rep"
+        << setw(12) << fixed << setprecision(1) << mbPerSec << " MiB/s\n";
+}
+
+template <typename F>
+static void run(const string& name, size_t bytesPerRep, int reps, F body)
+{
+    body();  // warm-up
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < reps; i++)
+        body();
+    report(name, bytesPerRep, reps, chrono::steady_clock::now() - start);
+}
+
+static vector<Directory_Entry> makeEntries(int count)
+{
+    vector<Directory_Entry> entries;
+    for (int i = 0; i < count; i++)
+    {
+        string name = "F" + to_string(i) + ".TXT";
+        Directory_Entry d(name, 0x00, 5 + (i % 1000));
+        d.dir_fileSize = i * 37;
+        entries.push_back(d);
+    }
+    return entries;
+}
+
+static void benchFAT(int scale)
+{
+    int fat[1024];
+    for (int i = 0; i < 1024; i++)
+        fat[i] = (i * 7) % 1024;
+
+    run("FAT encode (1024 entries)", 4096, 2000 * scale, [&]() {
+        vector<char> b = Converter::intArrayToByteArray(fat, 1024);
+        sink += Converter::splitBytes(b).size();
+        });
+
+    vector<char> bytes = Converter::intArrayToByteArray(fat, 1024);
+    int back[1024];
+    run("FAT decode (1024 entries)", 4096, 2000 * scale, [&]() {
+        Converter::byteArrayToIntArray(back, bytes);
+        sink += back[1023];
+        });
+}
+
+static void benchDirectory(int count, int scale)
+{
+    vector<Directory_Entry> entries = makeEntries(count);
+    size_t bytes = static_cast<size_t>(count) * 32;
+    int reps = max(1, static_cast<int>(200000 / count) * scale);
+
+    run("dir encode (" + to_string(count) + " records)", bytes, reps, [&]() {
+        vector<char> b = Converter::Directory_EntriesToBytes(entries);
+        sink += Converter::splitBytes(b).size();
+        });
+
+    vector<char> chain;
+    for (const auto& c : Converter::splitBytes(Converter::Directory_EntriesToBytes(entries)))
+        chain.insert(chain.end(), c.begin(), c.end());
+    run("dir decode (" + to_string(count) + " records)", bytes, reps, [&]() {
+        sink += Converter::BytesToDirectory_Entries(chain).size();
+        });
+}
+
+static void benchContent(size_t size, int scale)
+{
+    string content(size, 'x');
+    for (size_t i = 0; i < size; i++)
+        content[i] = static_cast<char>('a' + i % 26);
+    int reps = max(1, static_cast<int>((64u * 1024 * 1024) / (size + 1024)) * scale / 16);
+
+    run("content encode (" + to_string(size) + " B)", size, reps, [&]() {
+        vector<char> b = Converter::StringToBytes(content);
+        sink += Converter::splitBytes(b).size();
+        });
+
+    vector<char> chain;
+    for (const auto& c : Converter::splitBytes(Converter::StringToBytes(content)))
+        chain.insert(chain.end(), c.begin(), c.end());
+    run("content decode (" + to_string(size) + " B)", size, reps, [&]() {
+        sink += Converter::BytesToString(chain).size();
+        });
+}
+
+int main(int argc, char* argv[])
+{
+    int scale = (argc > 1) ? max(1, atoi(argv[1])) : 1;
+
+    benchFAT(scale);
+    // One cluster, a typical folder, and every data cluster of the disk used by one directory
+    for (int count : { 32, 256, 1019 * 32 })
+        benchDirectory(count, scale);
+    // One cluster, a typical text file, and the largest file the 1 MiB disk can hold
+    for (size_t size : { size_t(1000), size_t(16 * 1024), size_t(1019 * 1024 - 1) })
+        benchContent(size, scale);
+
+    cout << "(checksum " << sink << ")\n";
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "Converter.h"
+#include "Directory_Entry.h"
+#include "Name_Scan.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+    Randomized round-trip checker for Converter.
+
+    Usage: converter_fuzz [iterations] [disk image]...
+
+    Every iteration feeds random FAT arrays, directory records and file bodies
+    through the encode/decode pairs and checks that nothing is lost. Each disk
+    image given on the command line is decoded and re-encoded cluster by
+    cluster and must come back byte-for-byte identical.
+*/
+
+static int failures = 0;
+
+static void check(bool ok, const string& what)
+{
+    if (!ok)
+    {
+        failures++;
+        if (failures <= 20)
+            cout << "FAIL: " << what << "\n";
+    }
+}
+
+static Directory_Entry randomEntry(mt19937& rng)
+{
+    uniform_int_distribution<int> byte(0, 255);
+    uniform_int_distribution<int> printable(33, 126);
+    Directory_Entry d;
+    for (int i = 0; i < 11; i++)
+        d.dir_name[i] = static_cast<char>(i == 0 ? printable(rng) : byte(rng));
+    d.dir_attr = static_cast<char>(byte(rng));
+    for (int i = 0; i < 12; i++)
+        d.dir_empty[i] = static_cast<char>(byte(rng));
+    d.dir_firstCluster = static_cast<int>(rng());
+    d.dir_fileSize = static_cast<int>(rng());
+    return d;
+}
+
+static bool sameRecord(const Directory_Entry& a, const Directory_Entry& b)
+{
+    return memcmp(a.dir_name, b.dir_name, 11) == 0 &&
+        a.dir_attr == b.dir_attr &&
+        memcmp(a.dir_empty, b.dir_empty, 12) == 0 &&
+        a.dir_firstCluster == b.dir_firstCluster &&
+        a.dir_fileSize == b.dir_fileSize;
+}
+
+// The 32-byte record layout is part of the disk format; pin it with a known vector
+static void checkRecordLayout()
+{
+    Directory_Entry d;
+    memcpy(d.dir_name, "README  TXT", 11);
+    d.dir_attr = 0x00;
+    memset(d.dir_empty, ' ', 12);
+    d.dir_firstCluster = 0x00000107;
+    d.dir_fileSize = 0x00012345;
+
+    const unsigned char expected[32] = {
+        'R', 'E', 'A', 'D', 'M', 'E', ' ', ' ', 'T', 'X', 'T',
+        0x00,
+        ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+        0x07, 0x01, 0x00, 0x00,
+        0x45, 0x23, 0x01, 0x00
+    };
+    vector<char> bytes = Converter::Directory_EntryToBytes(d);
+    check(bytes.size() == 32, "directory record is not 32 bytes");
+    check(bytes.size() == 32 && memcmp(bytes.data(), expected, 32) == 0, "directory record layout changed");
+
+    vector<char> fat = Converter::intToByte(-1);
+    check(fat == vector<char>(4, static_cast<char>(0xFF)), "EOF marker encoding changed");
+}
+
+static void fuzzFAT(mt19937& rng)
+{
+    int fat[1024];
+    uniform_int_distribution<int> cluster(-1, 1023);
+    for (int i = 0; i < 1024; i++)
+        fat[i] = (rng() % 8 == 0) ? static_cast<int>(rng()) : cluster(rng);
+
+    vector<char> bytes = Converter::intArrayToByteArray(fat, 1024);
+    check(bytes.size() == 4096, "FAT encodes to the wrong size");
+
+    vector<vector<char>> clusters = Converter::splitBytes(bytes);
+    check(clusters.size() == 4, "FAT does not split into 4 clusters");
+
+    vector<char> joined;
+    for (const auto& c : clusters)
+    {
+        check(c.size() == 1024, "FAT cluster is not 1024 bytes");
+        joined.insert(joined.end(), c.begin(), c.end());
+    }
+
+    int back[1024];
+    Converter::byteArrayToIntArray(back, joined);
+    check(memcmp(fat, back, sizeof(fat)) == 0, "FAT round trip mismatch");
+}
+
+static void fuzzDirectory(mt19937& rng)
+{
+    int count = rng() % 200;
+    vector<Directory_Entry> entries;
+    for (int i = 0; i < count; i++)
+        entries.push_back(randomEntry(rng));
+
+    vector<char> bytes = Converter::Directory_EntriesToBytes(entries);
+    check(bytes.size() == entries.size() * 32, "directory encodes to the wrong size");
+
+    // Mimic Directory::readDirectory: split into clusters, then re-join the chain
+    vector<char> chain;
+    for (const auto& c : Converter::splitBytes(bytes))
+    {
+        check(c.size() == 1024, "directory cluster is not 1024 bytes");
+        chain.insert(chain.end(), c.begin(), c.end());
+    }
+
+    vector<Directory_Entry> back = Converter::BytesToDirectory_Entries(chain);
+    check(back.size() == entries.size(), "directory entry count mismatch");
+    for (size_t i = 0; i < back.size() && i < entries.size(); i++)
+    {
+        check(sameRecord(back[i], entries[i]), "directory record round trip mismatch");
+        // Short_Name ends at the first NUL, so only NUL-free names have to round trip through the text form
+        if (memchr(back[i].dir_name, 0, 11) == nullptr)
+            check(back[i].key == Directory_Entry::makeKey(back[i].getName()), "decoded name key does not match getName()");
+        check(back[i].key.equalsIgnoreCase(back[i].getShortName()), "decoded name key does not fold getShortName()");
+    }
+}
+
+static void fuzzContent(mt19937& rng)
+{
+    uniform_int_distribution<int> byte(1, 255);
+    string s(rng() % 5000, '\0');
+    for (char& c : s)
+        c = static_cast<char>(byte(rng));
+
+    vector<char> bytes = Converter::StringToBytes(s);
+    check(bytes.size() == s.size() + 1 && bytes.back() == '\0', "content is not NUL terminated");
+
+    vector<char> chain;
+    for (const auto& c : Converter::splitBytes(bytes))
+        chain.insert(chain.end(), c.begin(), c.end());
+    check(chain.size() % 1024 == 0, "content chain is not cluster aligned");
+
+    string back = Converter::BytesToString(chain);
+    check(back.compare(0, s.size(), s) == 0, "content round trip mismatch");
+}
+
+// Name_Scan must pick the same slot as decoding each record and comparing keys
+static void fuzzNameScan(mt19937& rng)
+{
+    // A small alphabet so names collide, differ only in case, or carry dots and padding
+    static const char alphabet[] = { 'a', 'A', 'b', 'B', '.', ' ', '1', '\x05', '\xE5' };
+    char cluster[1024] = {};
+    int records = 1 + rng() % 32;
+    for (int r = 0; r < records; r++)
+    {
+        char* record = cluster + r * 32;
+        int len = 1 + rng() % 11;
+        for (int i = 0; i < 11; i++)
+            record[i] = (i < len) ? alphabet[rng() % sizeof(alphabet)] : ' ';
+        if (record[0] == ' ')
+            record[0] = 'a';
+    }
+    if (rng() % 4 == 0)
+        cluster[(rng() % records) * 32] = 0;
+
+    const char* source = cluster + (rng() % records) * 32;
+    Short_Name key = (source[0] == 0 || rng() % 8 == 0) ? Short_Name("A.B") : Short_Name::fromDirName(source).folded();
+
+    int expected = -1;
+    for (int r = 0; r < records && cluster[r * 32] != 0; r++)
+    {
+        if (static_cast<unsigned char>(cluster[r * 32]) != 0xE5 && Short_Name::fromDirName(cluster + r * 32).folded() == key)
+        {
+            expected = r;
+            break;
+        }
+    }
+    bool ended = false;
+    check(Name_Scan(key).find(cluster, records, ended) == expected, "Name_Scan disagrees with a decoded scan for " + key.str());
+}
+
+// Decode and re-encode every cluster of an existing image; the bytes must not move
+static void checkImage(const string& path)
+{
+    ifstream in(path, ios::binary);
+    if (!in.is_open())
+    {
+        check(false, "cannot open image " + path);
+        return;
+    }
+    vector<char> image((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    int clusters = static_cast<int>(image.size() / 1024);
+
+    // Clusters 1-4 hold the FAT
+    if (clusters >= 5)
+    {
+        vector<char> fatBytes(image.begin() + 1024, image.begin() + 5 * 1024);
+        int fat[1024];
+        Converter::byteArrayToIntArray(fat, fatBytes);
+        check(Converter::intArrayToByteArray(fat, 1024) == fatBytes, "FAT bytes changed in " + path);
+    }
+
+    // Every other cluster is read back as a directory; decoded records must re-encode identically
+    for (int c = 5; c < clusters; c++)
+    {
+        vector<char> cluster(image.begin() + c * 1024, image.begin() + (c + 1) * 1024);
+        vector<Directory_Entry> entries = Converter::BytesToDirectory_Entries(cluster);
+        vector<char> again = Converter::Directory_EntriesToBytes(entries);
+        check(equal(again.begin(), again.end(), cluster.begin()),
+            "directory records changed in " + path + " cluster " + to_string(c));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = (argc > 1) ? atoi(argv[1]) : 1000;
+    mt19937 rng(20250116);
+
+    checkRecordLayout();
+    for (int i = 0; i < iterations; i++)
+    {
+        fuzzFAT(rng);
+        fuzzDirectory(rng);
+        fuzzContent(rng);
+        fuzzNameScan(rng);
+    }
+    for (int i = 2; i < argc; i++)
+        checkImage(argv[i]);
+
+    if (failures > 0)
+    {
+        cout << failures << " check(s) failed.\n";
+        return 1;
+    }
+    cout << "converter_fuzz: " << iterations << " iteration(s), " << (argc > 2 ? argc - 2 : 0)
+        << " image(s) OK.\n";
+    return 0;
+}
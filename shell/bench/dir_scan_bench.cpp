@@ -0,0 +1,130 @@
+#include "Converter.h"
+#include "Directory.h"
+#include "Directory_Entry.h"
+#include "Name_Scan.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+using namespace std;
+
+/*
+    Name lookup benchmark for large directories.
+
+    Usage: dir_scan_bench [scale]
+
+    Each case looks up the same mix of present and absent names (half each) in
+    a directory of 10k, 20k and 32k records, the last being every data cluster
+    of the disk:
+      decoded scan   compare keys of decoded entries one by one (the old searchDirectory loop)
+      raw scalar     fromDirName + fold on each raw record (cold lookup before Name_Scan)
+      raw Name_Scan  folded 16-byte compare of each raw record (cold lookup now)
+      name index     Directory::searchDirectory hash index on loaded entries
+    `scale` multiplies the number of lookups (default 1).
+*/
+
+// Accumulated and printed at the end so the optimizer keeps every lookup
+static size_t sink = 0;
+
+template <typename F>
+static void run(const string& name, int lookups, F body)
+{
+    body(0);  // warm-up
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++)
+        body(i);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << left << setw(34) << name
+        << right << setw(10) << lookups << " lookups"
+        << setw(12) << fixed << setprecision(2) << seconds * 1e6 / lookups << " us/lookup\n";
+}
+
+static void benchDirectory(int count, int scale)
+{
+    vector<Directory_Entry> entries;
+    for (int i = 0; i < count; i++)
+    {
+        // Mixed case and a few directories, as a real listing has
+        string name = (i % 3 == 0 ? "Doc" : "f") + to_string(i) + (i % 7 == 0 ? "" : ".TXT");
+        entries.push_back(Directory_Entry(name, i % 7 == 0 ? 0x10 : 0x00, 0));
+    }
+
+    vector<char> raw;
+    for (const auto& c : Converter::splitBytes(Converter::Directory_EntriesToBytes(entries)))
+        raw.insert(raw.end(), c.begin(), c.end());
+    int clusters = static_cast<int>(raw.size() / 1024);
+
+    mt19937 rng(count);
+    vector<Short_Name> queries;
+    for (int i = 0; i < 512; i++)
+    {
+        if (i % 2 == 0)
+            queries.push_back(entries[rng() % count].key);
+        else
+            queries.push_back(Directory_Entry::makeKey("missing" + to_string(i) + ".txt"));
+    }
+    vector<Name_Scan> scans(queries.begin(), queries.end());
+
+    int lookups = max(1, 2000000 / count) * scale;
+    string suffix = " (" + to_string(count) + ")";
+
+    run("decoded scan" + suffix, lookups, [&](int i) {
+        const Short_Name& key = queries[i % queries.size()];
+        for (size_t j = 0; j < entries.size(); j++)
+        {
+            if (entries[j].key == key)
+            {
+                sink += j;
+                break;
+            }
+        }
+        });
+
+    run("raw scalar" + suffix, lookups, [&](int i) {
+        const Short_Name& key = queries[i % queries.size()];
+        for (size_t at = 0; at < raw.size() && raw[at] != 0; at += 32)
+        {
+            if (Short_Name::fromDirName(raw.data() + at).folded() == key)
+            {
+                sink += at;
+                break;
+            }
+        }
+        });
+
+    run("raw Name_Scan" + suffix, lookups, [&](int i) {
+        const Name_Scan& scan = scans[i % scans.size()];
+        for (int c = 0; c < clusters; c++)
+        {
+            bool ended = false;
+            int slot = scan.find(raw.data() + c * 1024, 32, ended);
+            if (slot != -1)
+            {
+                sink += c * 32 + slot;
+                break;
+            }
+            if (ended)
+                break;
+        }
+        });
+
+    Directory dir("BENCH", 0x10, 0, nullptr);
+    dir.DirOrFiles = entries;
+    run("name index" + suffix, lookups * 100, [&](int i) {
+        sink += dir.searchDirectory(queries[i % queries.size()]) + 1;
+        });
+}
+
+int main(int argc, char* argv[])
+{
+    int scale = (argc > 1) ? max(1, atoi(argv[1])) : 1;
+
+    for (int count : { 10000, 20000, 1019 * 32 })
+        benchDirectory(count, scale);
+
+    cout << "(checksum " << sink << ")\n";
+    return 0;
+}
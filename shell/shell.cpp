@@ -7,25 +7,84 @@
 #include "Parser.h"
 #include "CommandProcessor.h"
 #include "Converter.h"
+#include "Content_Cache.h"
+#include "Dir_Cache.h"
+#include "Dir_Prefetch.h"
+#include "Dir_Warmup.h"
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <string>
 using namespace std;
 
-int main()
+int main(int argc, char* argv[])
 {
     // Path to the virtual disk file
     string diskPath = "virtual_disk.bin";
 
+    // Optional settings: --content-cache-kb N bounds the memory used for cached file bodies,
+    // --dir-cache-kb N the memory used for cached directories, --dir-slack N the blank clusters
+    // a growing directory reserves. --warm-threads N reads the directory tree on N threads before
+    // the first prompt, for at most --warm-ms milliseconds and --warm-kb KB of directories.
+    // --prefetch-dirs N sets how many subdirectories are read ahead after a cd (0 turns it off)
+    int warmThreads = 0;
+    long warmMs = 2000;
+    size_t warmBytes = Dir_Cache::DEFAULT_BUDGET;
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "--content-cache-kb")
+        {
+            Content_Cache::setBudget(static_cast<size_t>(atol(argv[++i])) * 1024);
+        }
+        else if (option == "--dir-cache-kb")
+        {
+            Dir_Cache::setBudget(static_cast<size_t>(atol(argv[++i])) * 1024);
+        }
+        else if (option == "--dir-slack")
+        {
+            Directory::setSlackClusters(atoi(argv[++i]));
+        }
+        else if (option == "--prefetch-dirs")
+        {
+            Dir_Prefetch::setLimit(atoi(argv[++i]));
+        }
+        else if (option == "--warm-threads")
+        {
+            warmThreads = atoi(argv[++i]);
+        }
+        else if (option == "--warm-ms")
+        {
+            warmMs = atol(argv[++i]);
+        }
+        else if (option == "--warm-kb")
+        {
+            warmBytes = static_cast<size_t>(atol(argv[++i])) * 1024;
+        }
+    }
+
     // Initialize or open the virtual disk and FAT
     Mini_FAT::initialize_Or_Open_FileSystem(diskPath);
 
-    // Create the root directory "C:\"
-    Directory* rootDir = new Directory("C:", 0x10, 0, nullptr);
-    rootDir->name = "C:";
+    // The root directory "C:\" always lives at cluster 5, the first cluster after the FAT
+    const int rootCluster = 5;
+    if (Mini_FAT::getClusterPointer(rootCluster) == 0)
+    {
+        Virtual_Disk::writeCluster(vector<char>(1024, 0), rootCluster);
+        Mini_FAT::setClusterPointer(rootCluster, -1);
+        Mini_FAT::writeFAT();
+    }
+    Directory* rootDir = new Directory("C:", 0x10, rootCluster, nullptr);
 
     rootDir->readDirectory(); 
 
+    if (warmThreads > 0)
+    {
+        Dir_Warmup::Result warm = Dir_Warmup::run(rootDir, warmThreads, chrono::milliseconds(warmMs), warmBytes);
+        cout << "Read " << warm.directories << " directories (" << warm.bytes / 1024 << " KB) ahead"
+            << (warm.complete ? "" : ", stopped at the time or memory budget") << endl;
+    }
+
     // Initialize the current directory to root
     Directory* currentDir = rootDir;
 
@@ -41,11 +100,23 @@ int main()
         string input;
         cout << currentDir->getFullPath() << " >> ";
         getline(cin, input);
+        // Read-ahead must be done before the command writes to the disk
+        Dir_Prefetch::finish();
+        Directory* previousDir = currentDir;
         cmdProcessor.processCommand(input, isRunning);
+        // No command is running, so unreferenced directories can be evicted safely
+        Dir_Cache::trim(currentDir);
+        if (isRunning && currentDir != previousDir && !currentDir->removed)
+            Dir_Prefetch::start(currentDir);
     }
 
-    // Cleanup: Delete the root directory (which recursively deletes subdirectories)
+    // Cleanup: reserved slack goes back to the FAT before it is written out. The cache owns every
+    // directory except the root (and a removed current directory, which the release frees)
+    Dir_Cache::releaseSlack();
+    rootDir->releaseSlack();
     Mini_FAT::CloseTheSystem();
+    Dir_Cache::release(currentDir);
+    Dir_Cache::clear();
     delete rootDir;
 
     return 0;